@@ -45,6 +45,7 @@ public class CapsuleTraceRotation : ModuleRules
                 "SlateCore",
                 "InputCore",
                 "Core",
+                "Json",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
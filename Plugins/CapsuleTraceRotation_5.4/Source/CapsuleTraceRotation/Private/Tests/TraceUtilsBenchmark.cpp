@@ -0,0 +1,248 @@
+// Copyright 2021, Revilian. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "TraceUtilsTestLevel.h"
+#include "TraceUtils.h"
+
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+#include "Kismet/KismetSystemLibrary.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+/**
+ * Measures the per-query cost of every UTraceUtils variant at several collider densities.
+ * The stock Kismet sweeps are measured alongside as a baseline.
+ *
+ * Results are written as JSON to <ProjectSaved>/Automation/CapsuleTraceRotation/TraceUtilsBenchmark.json,
+ * or to the path passed with -TraceUtilsBenchmarkOutput=<Path>.
+ *
+ * Run headless: -ExecCmds="Automation RunTests CapsuleTraceRotation.TraceUtils.Benchmark" -nullrhi -unattended
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTraceUtilsBenchmark, "CapsuleTraceRotation.TraceUtils.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+namespace TraceUtilsBenchmark
+{
+	//Total number of colliders, half of them static and half movable.
+	constexpr int32 Densities[] = { 500, 2000, 4000 };
+	constexpr int32 NumQueries = 2000;
+	constexpr int32 NumWarmupQueries = 100;
+
+	struct FVariantResult
+	{
+		FString Name;
+		double MeanUs = 0.0;
+		double MedianUs = 0.0;
+		double P95Us = 0.0;
+		double MaxUs = 0.0;
+		int32 NumHits = 0;
+	};
+
+	struct FDensityResult
+	{
+		int32 NumStaticColliders = 0;
+		int32 NumMovableColliders = 0;
+		TArray<FVariantResult> Variants;
+	};
+
+	/** Trace variant under measurement. Returns the number of hits produced by the query. */
+	using FVariantFunc = TFunction<int32(const FTraceUtilsTestQuery&)>;
+
+	FVariantResult Measure(const FString& Name, const TArray<FTraceUtilsTestQuery>& Queries, const FVariantFunc& Func)
+	{
+		FVariantResult Result;
+		Result.Name = Name;
+
+		//Warm up the caches and the physics scene query structures.
+		for (int32 i = 0; i < FMath::Min(NumWarmupQueries, Queries.Num()); ++i)
+		{
+			Func(Queries[i]);
+		}
+
+		TArray<double> Timings;
+		Timings.Reserve(Queries.Num());
+
+		for (const FTraceUtilsTestQuery& Query : Queries)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Result.NumHits += Func(Query);
+			Timings.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0);
+		}
+
+		if (Timings.Num() > 0)
+		{
+			double Sum = 0.0;
+
+			for (const double Timing : Timings)
+			{
+				Sum += Timing;
+			}
+
+			Timings.Sort();
+			Result.MeanUs = Sum / Timings.Num();
+			Result.MedianUs = Timings[Timings.Num() / 2];
+			Result.P95Us = Timings[FMath::Min(Timings.Num() - 1, FMath::FloorToInt(Timings.Num() * 0.95))];
+			Result.MaxUs = Timings.Last();
+		}
+
+		return Result;
+	}
+
+	FString GetOutputPath()
+	{
+		FString OutputPath;
+
+		if (!FParse::Value(FCommandLine::Get(), TEXT("TraceUtilsBenchmarkOutput="), OutputPath))
+		{
+			OutputPath = FPaths::Combine(FPaths::AutomationDir(), TEXT("CapsuleTraceRotation"), TEXT("TraceUtilsBenchmark.json"));
+		}
+
+		return OutputPath;
+	}
+
+	FString ToJson(const TArray<FDensityResult>& Results)
+	{
+		FString Json;
+		TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("benchmark"), TEXT("CapsuleTraceRotation.TraceUtils"));
+		Writer->WriteValue(TEXT("platform"), FString(FPlatformProperties::IniPlatformName()));
+		Writer->WriteValue(TEXT("seed"), FTraceUtilsTestLevel::DefaultSeed);
+		Writer->WriteValue(TEXT("queries"), NumQueries);
+		Writer->WriteArrayStart(TEXT("densities"));
+
+		for (const FDensityResult& Density : Results)
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue(TEXT("static_colliders"), Density.NumStaticColliders);
+			Writer->WriteValue(TEXT("movable_colliders"), Density.NumMovableColliders);
+			Writer->WriteArrayStart(TEXT("variants"));
+
+			for (const FVariantResult& Variant : Density.Variants)
+			{
+				Writer->WriteObjectStart();
+				Writer->WriteValue(TEXT("name"), Variant.Name);
+				Writer->WriteValue(TEXT("mean_us"), Variant.MeanUs);
+				Writer->WriteValue(TEXT("median_us"), Variant.MedianUs);
+				Writer->WriteValue(TEXT("p95_us"), Variant.P95Us);
+				Writer->WriteValue(TEXT("max_us"), Variant.MaxUs);
+				Writer->WriteValue(TEXT("hits"), Variant.NumHits);
+				Writer->WriteObjectEnd();
+			}
+
+			Writer->WriteArrayEnd();
+			Writer->WriteObjectEnd();
+		}
+
+		Writer->WriteArrayEnd();
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		return Json;
+	}
+}
+
+bool FTraceUtilsBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TraceUtilsBenchmark;
+
+	const TArray<AActor*> ActorsToIgnore;
+	const TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes = FTraceUtilsTestLevel::GetObjectTypes();
+	const ETraceTypeQuery TraceChannel = FTraceUtilsTestLevel::GetTraceChannel();
+	const FName TraceProfile = FTraceUtilsTestLevel::GetTraceProfile();
+
+	TArray<FDensityResult> Results;
+
+	for (const int32 Density : Densities)
+	{
+		FTraceUtilsTestLevel Level;
+		const int32 NumStatic = Density / 2;
+		const int32 NumMovable = Density - NumStatic;
+
+		if (!TestTrue(FString::Printf(TEXT("Test level with %d colliders is created"), Density), Level.Create(NumStatic, NumMovable)))
+		{
+			continue;
+		}
+
+		const UObject* const WorldContext = Level.GetContextActor();
+
+		TArray<FTraceUtilsTestQuery> Queries;
+		Level.GenerateQueries(NumQueries, true, Queries);
+
+		FDensityResult& DensityResult = Results.AddDefaulted_GetRef();
+		DensityResult.NumStaticColliders = NumStatic;
+		DensityResult.NumMovableColliders = NumMovable;
+
+		FHitResult Hit;
+		TArray<FHitResult> Hits;
+
+		DensityResult.Variants.Add(Measure(TEXT("SingleByChannel"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				return (int32)UTraceUtils::CapsuleTraceSingle(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("MultiByChannel"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				UTraceUtils::CapsuleTraceMulti(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+				return Hits.Num();
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("SingleForObjects"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				return (int32)UTraceUtils::CapsuleTraceSingleForObjects(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("MultiForObjects"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				UTraceUtils::CapsuleTraceMultiForObjects(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+				return Hits.Num();
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("SingleByProfile"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				return (int32)UTraceUtils::CapsuleTraceSingleByProfile(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("MultiByProfile"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				UTraceUtils::CapsuleTraceMultiByProfile(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, Q.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+				return Hits.Num();
+			}));
+
+		//Baseline. Upright capsules only, so the hit counts are not comparable with the rotated variants.
+		DensityResult.Variants.Add(Measure(TEXT("Kismet.SingleByChannel"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				return (int32)UKismetSystemLibrary::CapsuleTraceSingle(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+			}));
+
+		DensityResult.Variants.Add(Measure(TEXT("Kismet.MultiByChannel"), Queries, [&](const FTraceUtilsTestQuery& Q)
+			{
+				UKismetSystemLibrary::CapsuleTraceMulti(WorldContext, Q.Start, Q.End, Q.Radius, Q.HalfHeight, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+				return Hits.Num();
+			}));
+
+		for (const FVariantResult& Variant : DensityResult.Variants)
+		{
+			AddInfo(FString::Printf(TEXT("%5d colliders | %-24s mean %7.2fus | median %7.2fus | p95 %7.2fus | hits %d"),
+				Density, *Variant.Name, Variant.MeanUs, Variant.MedianUs, Variant.P95Us, Variant.NumHits));
+		}
+	}
+
+	const FString OutputPath = GetOutputPath();
+
+	if (TestTrue(TEXT("Benchmark results are saved"), FFileHelper::SaveStringToFile(ToJson(Results), *OutputPath)))
+	{
+		AddInfo(FString::Printf(TEXT("Benchmark results are saved to %s"), *OutputPath));
+	}
+
+	return !HasAnyErrors();
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,192 @@
+// Copyright 2021, Revilian. All Rights Reserved.
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "TraceUtilsTestLevel.h"
+#include "TraceUtils.h"
+
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "CollisionQueryParams.h"
+#include "Kismet/KismetSystemLibrary.h"
+
+/**
+ * Verifies that UTraceUtils produces the same hits as the stock sweeps.
+ * Upright and yaw-only capsules are symmetric, so they are compared with the stock Kismet sweeps.
+ * Arbitrary orientations are compared with the raw UWorld sweeps with the same rotation.
+ *
+ * Run headless: -ExecCmds="Automation RunTests CapsuleTraceRotation.TraceUtils.Correctness" -nullrhi -unattended
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTraceUtilsCorrectnessTest, "CapsuleTraceRotation.TraceUtils.Correctness", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+namespace TraceUtilsCorrectness
+{
+	constexpr int32 NumStaticColliders = 1500;
+	constexpr int32 NumMovableColliders = 1500;
+	constexpr int32 NumQueries = 400;
+	constexpr float LocationTolerance = 0.1f;
+
+	bool AreHitsEqual(FAutomationTestBase& Test, const FString& What, const FHitResult& Actual, const FHitResult& Expected)
+	{
+		bool bResult = true;
+		bResult &= Test.TestEqual(What + TEXT(" bBlockingHit"), Actual.bBlockingHit, Expected.bBlockingHit);
+		bResult &= Test.TestEqual(What + TEXT(" Component"), Actual.GetComponent(), Expected.GetComponent());
+		bResult &= Test.TestEqual(What + TEXT(" Location"), Actual.Location, Expected.Location, LocationTolerance);
+		bResult &= Test.TestEqual(What + TEXT(" ImpactPoint"), Actual.ImpactPoint, Expected.ImpactPoint, LocationTolerance);
+		bResult &= Test.TestEqual(What + TEXT(" Distance"), Actual.Distance, Expected.Distance, LocationTolerance);
+		return bResult;
+	}
+
+	bool AreHitsEqual(FAutomationTestBase& Test, const FString& What, const TArray<FHitResult>& Actual, const TArray<FHitResult>& Expected)
+	{
+		if (!Test.TestEqual(What + TEXT(" Num"), Actual.Num(), Expected.Num()))
+		{
+			return false;
+		}
+
+		bool bResult = true;
+
+		for (int32 i = 0; i < Actual.Num(); ++i)
+		{
+			bResult &= AreHitsEqual(Test, FString::Printf(TEXT("%s[%d]"), *What, i), Actual[i], Expected[i]);
+		}
+
+		return bResult;
+	}
+
+	FCollisionQueryParams MakeReferenceParams(FName TraceTag)
+	{
+		//Mirrors UTraceUtils::ConfigureCollisionParams() without ignored actors.
+		FCollisionQueryParams Params(TraceTag, SCENE_QUERY_STAT_ONLY(KismetTraceUtils), false);
+		Params.bReturnPhysicalMaterial = true;
+		return Params;
+	}
+
+	FCollisionObjectQueryParams MakeReferenceObjectParams(const TArray<TEnumAsByte<EObjectTypeQuery>>& ObjectTypes)
+	{
+		FCollisionObjectQueryParams ObjectParams;
+
+		for (const TEnumAsByte<EObjectTypeQuery>& ObjectType : ObjectTypes)
+		{
+			ObjectParams.AddObjectTypesToQuery(UEngineTypes::ConvertToCollisionChannel(ObjectType));
+		}
+
+		return ObjectParams;
+	}
+}
+
+bool FTraceUtilsCorrectnessTest::RunTest(const FString& Parameters)
+{
+	using namespace TraceUtilsCorrectness;
+
+	FTraceUtilsTestLevel Level;
+
+	if (!TestTrue(TEXT("Test level is created"), Level.Create(NumStaticColliders, NumMovableColliders)))
+	{
+		return false;
+	}
+
+	UWorld* const World = Level.GetWorld();
+	const UObject* const WorldContext = Level.GetContextActor();
+	const TArray<AActor*> ActorsToIgnore;
+	const TArray<TEnumAsByte<EObjectTypeQuery>> ObjectTypes = FTraceUtilsTestLevel::GetObjectTypes();
+	const ETraceTypeQuery TraceChannel = FTraceUtilsTestLevel::GetTraceChannel();
+	const FName TraceProfile = FTraceUtilsTestLevel::GetTraceProfile();
+
+	TArray<FTraceUtilsTestQuery> Queries;
+	int32 NumBlockingHits = 0;
+
+	//Symmetric capsules against the stock Kismet sweeps.
+	Level.GenerateQueries(NumQueries, false, Queries);
+
+	for (int32 i = 0; i < Queries.Num(); ++i)
+	{
+		FTraceUtilsTestQuery Query = Queries[i];
+
+		//Every odd query is rotated around the capsule axis, which must not affect the result.
+		if (i % 2)
+		{
+			Query.Orientation.Yaw = 37.f * i;
+		}
+
+		FHitResult Hit, ExpectedHit;
+		TArray<FHitResult> Hits, ExpectedHits;
+
+		const bool bHit = UTraceUtils::CapsuleTraceSingle(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		const bool bExpectedHit = UKismetSystemLibrary::CapsuleTraceSingle(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHit, false);
+		TestEqual(FString::Printf(TEXT("SingleByChannel[%d] result"), i), bHit, bExpectedHit);
+		AreHitsEqual(*this, FString::Printf(TEXT("SingleByChannel[%d]"), i), Hit, ExpectedHit);
+		NumBlockingHits += bHit;
+
+		UTraceUtils::CapsuleTraceMulti(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		UKismetSystemLibrary::CapsuleTraceMulti(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHits, false);
+		AreHitsEqual(*this, FString::Printf(TEXT("MultiByChannel[%d]"), i), Hits, ExpectedHits);
+
+		UTraceUtils::CapsuleTraceSingleForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		UKismetSystemLibrary::CapsuleTraceSingleForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHit, false);
+		AreHitsEqual(*this, FString::Printf(TEXT("SingleForObjects[%d]"), i), Hit, ExpectedHit);
+
+		UTraceUtils::CapsuleTraceMultiForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		UKismetSystemLibrary::CapsuleTraceMultiForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHits, false);
+		AreHitsEqual(*this, FString::Printf(TEXT("MultiForObjects[%d]"), i), Hits, ExpectedHits);
+
+		UTraceUtils::CapsuleTraceSingleByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		UKismetSystemLibrary::CapsuleTraceSingleByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHit, false);
+		AreHitsEqual(*this, FString::Printf(TEXT("SingleByProfile[%d]"), i), Hit, ExpectedHit);
+
+		UTraceUtils::CapsuleTraceMultiByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		UKismetSystemLibrary::CapsuleTraceMultiByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, ExpectedHits, false);
+		AreHitsEqual(*this, FString::Printf(TEXT("MultiByProfile[%d]"), i), Hits, ExpectedHits);
+	}
+
+	//Arbitrary orientations against the raw world sweeps.
+	Level.GenerateQueries(NumQueries, true, Queries);
+
+	const FCollisionObjectQueryParams ObjectParams = MakeReferenceObjectParams(ObjectTypes);
+	const ECollisionChannel CollisionChannel = UEngineTypes::ConvertToCollisionChannel(TraceChannel);
+
+	for (int32 i = 0; i < Queries.Num(); ++i)
+	{
+		const FTraceUtilsTestQuery& Query = Queries[i];
+		const FCollisionShape Shape = FCollisionShape::MakeCapsule(Query.Radius, Query.HalfHeight);
+		const FQuat Rotation = Query.Orientation.Quaternion();
+
+		FHitResult Hit, ExpectedHit;
+		TArray<FHitResult> Hits, ExpectedHits;
+
+		const bool bHit = UTraceUtils::CapsuleTraceSingle(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		const bool bExpectedHit = World->SweepSingleByChannel(ExpectedHit, Query.Start, Query.End, Rotation, CollisionChannel, Shape, MakeReferenceParams(TEXT("CapsuleTraceSingleByChannelWithRotation")));
+		TestEqual(FString::Printf(TEXT("RotatedSingleByChannel[%d] result"), i), bHit, bExpectedHit);
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedSingleByChannel[%d]"), i), Hit, ExpectedHit);
+		NumBlockingHits += bHit;
+
+		UTraceUtils::CapsuleTraceMulti(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceChannel, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		World->SweepMultiByChannel(ExpectedHits, Query.Start, Query.End, Rotation, CollisionChannel, Shape, MakeReferenceParams(TEXT("CapsuleTraceMultiByChannelWithRotation")));
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedMultiByChannel[%d]"), i), Hits, ExpectedHits);
+
+		UTraceUtils::CapsuleTraceSingleForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		World->SweepSingleByObjectType(ExpectedHit, Query.Start, Query.End, Rotation, ObjectParams, Shape, MakeReferenceParams(TEXT("CapsuleTraceSingleForObjectsWithRotation")));
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedSingleForObjects[%d]"), i), Hit, ExpectedHit);
+
+		UTraceUtils::CapsuleTraceMultiForObjects(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, ObjectTypes, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		World->SweepMultiByObjectType(ExpectedHits, Query.Start, Query.End, Rotation, ObjectParams, Shape, MakeReferenceParams(TEXT("CapsuleTraceMultiForObjectsWithRotation")));
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedMultiForObjects[%d]"), i), Hits, ExpectedHits);
+
+		UTraceUtils::CapsuleTraceSingleByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hit, false);
+		World->SweepSingleByProfile(ExpectedHit, Query.Start, Query.End, Rotation, TraceProfile, Shape, MakeReferenceParams(TEXT("CapsuleTraceSingleByProfileWithRotation")));
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedSingleByProfile[%d]"), i), Hit, ExpectedHit);
+
+		UTraceUtils::CapsuleTraceMultiByProfile(WorldContext, Query.Start, Query.End, Query.Radius, Query.HalfHeight, Query.Orientation, TraceProfile, false, ActorsToIgnore, EDrawDebugTrace::None, Hits, false);
+		World->SweepMultiByProfile(ExpectedHits, Query.Start, Query.End, Rotation, TraceProfile, Shape, MakeReferenceParams(TEXT("CapsuleTraceMultiByProfileWithRotation")));
+		AreHitsEqual(*this, FString::Printf(TEXT("RotatedMultiByProfile[%d]"), i), Hits, ExpectedHits);
+	}
+
+	//The level must be dense enough for the comparison to be meaningful.
+	TestTrue(TEXT("Queries produce blocking hits"), NumBlockingHits > NumQueries / 4);
+
+	return !HasAnyErrors();
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,170 @@
+// Copyright 2021, Revilian. All Rights Reserved.
+
+#include "TraceUtilsTestLevel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/CollisionProfile.h"
+#include "GameFramework/Actor.h"
+#include "Components/BoxComponent.h"
+#include "Components/SphereComponent.h"
+#include "Components/CapsuleComponent.h"
+
+//Vertical extent of the populated area. Most of the levels are much wider than taller.
+static constexpr float LevelHeight = 2000.f;
+
+FTraceUtilsTestLevel::~FTraceUtilsTestLevel()
+{
+	Destroy();
+}
+
+bool FTraceUtilsTestLevel::Create(int32 NumStaticColliders, int32 NumMovableColliders, int32 Seed)
+{
+	Destroy();
+
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("TraceUtilsTestWorld"));
+
+	if (!World)
+	{
+		return false;
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	ContextActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+
+	FRandomStream Stream(Seed);
+
+	for (int32 i = 0; i < NumStaticColliders; ++i)
+	{
+		SpawnCollider(Stream, false);
+	}
+
+	for (int32 i = 0; i < NumMovableColliders; ++i)
+	{
+		SpawnCollider(Stream, true);
+	}
+
+	NumColliders = NumStaticColliders + NumMovableColliders;
+
+	//Flush pending render and physics state updates.
+	World->SendAllEndOfFrameUpdates();
+
+	return ContextActor != nullptr;
+}
+
+void FTraceUtilsTestLevel::Destroy()
+{
+	if (World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		World = nullptr;
+		ContextActor = nullptr;
+		NumColliders = 0;
+	}
+}
+
+AActor* FTraceUtilsTestLevel::SpawnCollider(FRandomStream& Stream, bool bMovable)
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	const FVector Location(Stream.FRandRange(-LevelHalfExtent, LevelHalfExtent), Stream.FRandRange(-LevelHalfExtent, LevelHalfExtent), Stream.FRandRange(0.f, LevelHeight));
+	const FRotator Rotation(Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f));
+	const FTransform Transform(Rotation, Location);
+
+	AActor* const Actor = World->SpawnActor<AActor>(AActor::StaticClass(), Transform, SpawnParams);
+
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	UShapeComponent* Shape = nullptr;
+
+	switch (Stream.RandRange(0, 2))
+	{
+	case 0:
+	{
+		UBoxComponent* const Box = NewObject<UBoxComponent>(Actor, NAME_None, RF_Transient);
+		Box->SetBoxExtent(FVector(Stream.FRandRange(50.f, 400.f), Stream.FRandRange(50.f, 400.f), Stream.FRandRange(50.f, 400.f)), false);
+		Shape = Box;
+		break;
+	}
+
+	case 1:
+	{
+		USphereComponent* const Sphere = NewObject<USphereComponent>(Actor, NAME_None, RF_Transient);
+		Sphere->SetSphereRadius(Stream.FRandRange(50.f, 300.f), false);
+		Shape = Sphere;
+		break;
+	}
+
+	default:
+	{
+		UCapsuleComponent* const Capsule = NewObject<UCapsuleComponent>(Actor, NAME_None, RF_Transient);
+		const float CapsuleRadius = Stream.FRandRange(30.f, 150.f);
+		Capsule->SetCapsuleSize(CapsuleRadius, CapsuleRadius + Stream.FRandRange(0.f, 250.f), false);
+		Shape = Capsule;
+		break;
+	}
+	}
+
+	Shape->SetMobility(bMovable ? EComponentMobility::Movable : EComponentMobility::Static);
+	Shape->SetCollisionProfileName(bMovable ? UCollisionProfile::BlockAllDynamic_ProfileName : UCollisionProfile::BlockAll_ProfileName);
+	Shape->SetRelativeTransform(Transform);
+	Actor->SetRootComponent(Shape);
+	Shape->RegisterComponent();
+
+	return Actor;
+}
+
+void FTraceUtilsTestLevel::GenerateQueries(int32 NumQueries, bool bRandomOrientation, TArray<FTraceUtilsTestQuery>& OutQueries, int32 Seed) const
+{
+	FRandomStream Stream(Seed);
+
+	OutQueries.Reset(NumQueries);
+
+	for (int32 i = 0; i < NumQueries; ++i)
+	{
+		FTraceUtilsTestQuery& Query = OutQueries.AddDefaulted_GetRef();
+		Query.Start = FVector(Stream.FRandRange(-LevelHalfExtent, LevelHalfExtent), Stream.FRandRange(-LevelHalfExtent, LevelHalfExtent), Stream.FRandRange(0.f, LevelHeight));
+
+		FVector Direction = Stream.GetUnitVector();
+		Direction.Z *= 0.25f; //Mostly horizontal sweeps, like melee weapons and characters.
+		Query.End = Query.Start + Direction.GetSafeNormal() * Stream.FRandRange(1000.f, 6000.f);
+
+		Query.Radius = Stream.FRandRange(20.f, 80.f);
+		Query.HalfHeight = Query.Radius + Stream.FRandRange(0.f, 150.f);
+
+		if (bRandomOrientation)
+		{
+			Query.Orientation = FRotator(Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f), Stream.FRandRange(-180.f, 180.f));
+		}
+	}
+}
+
+TArray<TEnumAsByte<EObjectTypeQuery>> FTraceUtilsTestLevel::GetObjectTypes()
+{
+	return { UEngineTypes::ConvertToObjectType(ECC_WorldStatic), UEngineTypes::ConvertToObjectType(ECC_WorldDynamic) };
+}
+
+ETraceTypeQuery FTraceUtilsTestLevel::GetTraceChannel()
+{
+	return UEngineTypes::ConvertToTraceType(ECC_Visibility);
+}
+
+FName FTraceUtilsTestLevel::GetTraceProfile()
+{
+	return UCollisionProfile::Pawn_ProfileName;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,81 @@
+// Copyright 2021, Revilian. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/EngineTypes.h"
+#include "Kismet/KismetSystemLibrary.h"
+
+class UWorld;
+class AActor;
+
+/**
+ * A single capsule sweep used by the TraceUtils tests and benchmarks.
+ */
+struct FTraceUtilsTestQuery
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	float Radius = 0.f;
+	float HalfHeight = 0.f;
+	FRotator Orientation = FRotator::ZeroRotator;
+};
+
+/**
+ * Procedural headless test level populated with static and movable primitive colliders.
+ * Creates its own game world, so it can be used with -nullrhi and without any map assets.
+ */
+class FTraceUtilsTestLevel
+{
+public:
+
+	/** Default seed used by all tests to keep the results reproducible. */
+	static constexpr int32 DefaultSeed = 0x5EED;
+
+	/** Half extent of the cube in which colliders and queries are generated. */
+	static constexpr float LevelHalfExtent = 10000.f;
+
+	FTraceUtilsTestLevel() = default;
+	~FTraceUtilsTestLevel();
+
+	FTraceUtilsTestLevel(const FTraceUtilsTestLevel&) = delete;
+	FTraceUtilsTestLevel& operator=(const FTraceUtilsTestLevel&) = delete;
+
+	/** Creates the world and spawns the given number of static and movable colliders. */
+	bool Create(int32 NumStaticColliders, int32 NumMovableColliders, int32 Seed = DefaultSeed);
+
+	/** Destroys the world, if it exists. */
+	void Destroy();
+
+	/** Generates capsule sweeps through the populated area. If bRandomOrientation is false, all capsules are upright. */
+	void GenerateQueries(int32 NumQueries, bool bRandomOrientation, TArray<FTraceUtilsTestQuery>& OutQueries, int32 Seed = DefaultSeed) const;
+
+	UWorld* GetWorld() const { return World; }
+
+	/** Actor used as a world context object. Has no collision. */
+	AActor* GetContextActor() const { return ContextActor; }
+
+	int32 GetNumColliders() const { return NumColliders; }
+
+	/** Object types of the spawned colliders. */
+	static TArray<TEnumAsByte<EObjectTypeQuery>> GetObjectTypes();
+
+	/** Trace channel that all spawned colliders block. */
+	static ETraceTypeQuery GetTraceChannel();
+
+	/** Profile that all spawned colliders block. */
+	static FName GetTraceProfile();
+
+private:
+
+	AActor* SpawnCollider(FRandomStream& Stream, bool bMovable);
+
+	UWorld* World = nullptr;
+	AActor* ContextActor = nullptr;
+	int32 NumColliders = 0;
+};
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,220 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "ExtensionTickManager.h"
+#include "LockOnTargetExtensions/LockOnTargetExtensionBase.h"
+#include "LockOnTargetDefines.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+/********************************************************************
+ * FLockOnTargetExtensionBatchTickFunction
+ ********************************************************************/
+
+void FLockOnTargetExtensionBatchTickFunction::AddExtension(ULockOnTargetExtensionProxy* Extension)
+{
+	check(Extension && Extension->BatchTickIndex == INDEX_NONE);
+
+	Extension->BatchTickIndex = Extensions.Add(Extension);
+	AccumulatedTimes.Add(0.f);
+
+	if (!IsTickFunctionEnabled())
+	{
+		SetTickFunctionEnable(true);
+	}
+}
+
+void FLockOnTargetExtensionBatchTickFunction::RemoveExtension(ULockOnTargetExtensionProxy* Extension)
+{
+	check(Extension && Extensions.IsValidIndex(Extension->BatchTickIndex) && Extensions[Extension->BatchTickIndex] == Extension);
+
+	const int32 Index = Extension->BatchTickIndex;
+	Extension->BatchTickIndex = INDEX_NONE;
+
+	if (bIsExecuting)
+	{
+		Extensions[Index] = nullptr;
+		bHasRemovedExtensions = true;
+	}
+	else
+	{
+		RemoveExtensionAt(Index);
+	}
+}
+
+void FLockOnTargetExtensionBatchTickFunction::RemoveExtensionAt(int32 Index)
+{
+	Extensions.RemoveAtSwap(Index, 1, false);
+	AccumulatedTimes.RemoveAtSwap(Index, 1, false);
+
+	if (Extensions.IsValidIndex(Index) && Extensions[Index])
+	{
+		Extensions[Index]->BatchTickIndex = Index;
+	}
+
+	//Don't pay for scheduling an empty batch.
+	if (Extensions.IsEmpty() && IsTickFunctionEnabled())
+	{
+		SetTickFunctionEnable(false);
+	}
+}
+
+void FLockOnTargetExtensionBatchTickFunction::CompactExtensions()
+{
+	bHasRemovedExtensions = false;
+
+	for (int32 i = Extensions.Num() - 1; i >= 0; --i)
+	{
+		if (!Extensions[i])
+		{
+			RemoveExtensionAt(i);
+		}
+	}
+}
+
+void FLockOnTargetExtensionBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	LOT_SCOPED_EVENT(ExtensionBatchUpdate);
+
+	bIsExecuting = true;
+
+	//Extensions enabled during the tick are appended and updated in the same frame.
+	for (int32 i = 0; i < Extensions.Num(); ++i)
+	{
+		ULockOnTargetExtensionProxy* const Extension = Extensions[i];
+
+		if (!IsValid(Extension))
+		{
+			continue;
+		}
+
+		AccumulatedTimes[i] += DeltaTime;
+
+		if (AccumulatedTimes[i] >= Extension->ExtensionTick.TickInterval)
+		{
+			const float ExtensionDeltaTime = AccumulatedTimes[i];
+			AccumulatedTimes[i] = 0.f;
+			Extension->Update(ExtensionDeltaTime);
+		}
+	}
+
+	bIsExecuting = false;
+
+	if (bHasRemovedExtensions)
+	{
+		CompactExtensions();
+	}
+}
+
+FString FLockOnTargetExtensionBatchTickFunction::DiagnosticMessage()
+{
+	return GetNameSafe(ExtensionClass) + TEXT("[BatchUpdate]");
+}
+
+FName FLockOnTargetExtensionBatchTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return ExtensionClass ? ExtensionClass->GetFName() : NAME_None;
+}
+
+/********************************************************************
+ * UExtensionTickManager
+ ********************************************************************/
+
+UExtensionTickManager::UExtensionTickManager()
+{
+	//Do something.
+}
+
+UExtensionTickManager& UExtensionTickManager::Get(UWorld& InWorld)
+{
+	checkf(InWorld.HasSubsystem<ThisClass>(), TEXT("Unable to access the ExtensionTickManager subsystem."));
+	return *InWorld.GetSubsystem<ThisClass>();
+}
+
+bool UExtensionTickManager::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+void UExtensionTickManager::Deinitialize()
+{
+	//Extensions might outlive the manager on the world teardown, so they must not reach the destroyed batches.
+	for (ULockOnTargetExtensionProxy* const Extension : RegisteredExtensions)
+	{
+		Extension->BatchTick = nullptr;
+		Extension->BatchTickIndex = INDEX_NONE;
+	}
+
+	RegisteredExtensions.Reset();
+
+	for (TPair<FBatchKey, TUniquePtr<FLockOnTargetExtensionBatchTickFunction>>& Batch : Batches)
+	{
+		if (Batch.Value->IsTickFunctionRegistered())
+		{
+			Batch.Value->UnRegisterTickFunction();
+		}
+	}
+
+	Batches.Reset();
+	Super::Deinitialize();
+}
+
+bool UExtensionTickManager::CanBatchExtension(const ULockOnTargetExtensionProxy* Extension)
+{
+	check(Extension);
+
+	//The batch would wait for the prerequisites of all its extensions. const_cast as the getter isn't const.
+	return const_cast<FLockOnTargetExtensionTickFunction&>(Extension->ExtensionTick).GetPrerequisites().IsEmpty();
+}
+
+void UExtensionTickManager::RegisterExtension(ULockOnTargetExtensionProxy* Extension)
+{
+	check(Extension && !Extension->BatchTick && CanBatchExtension(Extension));
+
+	FLockOnTargetExtensionTickFunction& ExtensionTick = Extension->ExtensionTick;
+
+	FBatchKey Key;
+	Key.ExtensionClass = Extension->GetClass();
+	Key.TickGroup = ExtensionTick.TickGroup;
+	Key.EndTickGroup = ExtensionTick.EndTickGroup;
+	Key.bTickEvenWhenPaused = ExtensionTick.bTickEvenWhenPaused;
+	Key.bAllowTickOnDedicatedServer = ExtensionTick.bAllowTickOnDedicatedServer;
+	Key.bHighPriority = ExtensionTick.bHighPriority;
+
+	TUniquePtr<FLockOnTargetExtensionBatchTickFunction>& Batch = Batches.FindOrAdd(Key);
+
+	if (!Batch.IsValid())
+	{
+		Batch = MakeUnique<FLockOnTargetExtensionBatchTickFunction>();
+		Batch->ExtensionClass = Extension->GetClass();
+		Batch->TickGroup = Key.TickGroup;
+		Batch->EndTickGroup = Key.EndTickGroup;
+		Batch->bTickEvenWhenPaused = Key.bTickEvenWhenPaused;
+		Batch->bAllowTickOnDedicatedServer = Key.bAllowTickOnDedicatedServer;
+		Batch->bHighPriority = Key.bHighPriority;
+		Batch->bCanEverTick = true;
+		Batch->bStartWithTickEnabled = false;
+		Batch->RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	Extension->BatchTick = Batch.Get();
+	RegisteredExtensions.Add(Extension);
+}
+
+void UExtensionTickManager::UnregisterExtension(ULockOnTargetExtensionProxy* Extension)
+{
+	check(Extension);
+
+	if (RegisteredExtensions.Remove(Extension) == 0)
+	{
+		return;
+	}
+
+	check(Extension->BatchTick);
+
+	if (Extension->BatchTickIndex != INDEX_NONE)
+	{
+		Extension->BatchTick->RemoveExtension(Extension);
+	}
+
+	Extension->BatchTick = nullptr;
+}
@@ -0,0 +1,114 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "FindTargetScheduler.h"
+#include "LockOnTargetDefines.h"
+#include "Engine/World.h"
+
+UFindTargetScheduler::UFindTargetScheduler()
+	: FrameBudget(500.f)
+{
+}
+
+UFindTargetScheduler& UFindTargetScheduler::Get(UWorld& InWorld)
+{
+	checkf(InWorld.HasSubsystem<ThisClass>(), TEXT("Unable to access the FindTargetScheduler subsystem."));
+	return *InWorld.GetSubsystem<ThisClass>();
+}
+
+bool UFindTargetScheduler::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+void UFindTargetScheduler::Deinitialize()
+{
+	PendingRequests.Reset();
+	Super::Deinitialize();
+}
+
+TStatId UFindTargetScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFindTargetScheduler, STATGROUP_Tickables);
+}
+
+void UFindTargetScheduler::ScheduleRequest(const UObject* Owner, FSimpleDelegate&& Request)
+{
+	check(Owner);
+
+	FScheduledRequest* const Pending = PendingRequests.FindByPredicate([Owner](const FScheduledRequest& ScheduledRequest) { return ScheduledRequest.Owner == Owner; });
+
+	if (Pending)
+	{
+		Pending->Request = MoveTemp(Request);
+	}
+	else
+	{
+		PendingRequests.Add({ Owner, MoveTemp(Request) });
+	}
+}
+
+void UFindTargetScheduler::CancelRequest(const UObject* Owner)
+{
+	//Indices of the processed requests must stay stable during the tick.
+	if (bIsProcessingRequests)
+	{
+		if (FScheduledRequest* const Pending = PendingRequests.FindByPredicate([Owner](const FScheduledRequest& ScheduledRequest) { return ScheduledRequest.Owner == Owner; }))
+		{
+			Pending->Owner.Reset();
+			Pending->Request.Unbind();
+		}
+	}
+	else
+	{
+		PendingRequests.RemoveAll([Owner](const FScheduledRequest& ScheduledRequest) { return ScheduledRequest.Owner == Owner; });
+	}
+}
+
+bool UFindTargetScheduler::HasPendingRequest(const UObject* Owner) const
+{
+	return PendingRequests.ContainsByPredicate([Owner](const FScheduledRequest& ScheduledRequest) { return ScheduledRequest.Owner == Owner && ScheduledRequest.Request.IsBound(); });
+}
+
+void UFindTargetScheduler::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingRequests.IsEmpty())
+	{
+		return;
+	}
+
+	LOT_SCOPED_EVENT(FindTargetScheduler_Tick);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const double Budget = FrameBudget / 1e6;
+
+	//Requests scheduled while processing are appended and wait for the next frame.
+	const int32 NumRequests = PendingRequests.Num();
+	bIsProcessingRequests = true;
+
+	for (int32 Index = 0; Index < NumRequests; ++Index)
+	{
+		//The request is cleared before execution as it may schedule or cancel other requests. The array might grow, so nothing is referenced.
+		const FScheduledRequest ScheduledRequest = MoveTemp(PendingRequests[Index]);
+		PendingRequests[Index].Owner.Reset();
+		PendingRequests[Index].Request.Unbind();
+
+		if (!ScheduledRequest.Owner.IsValid() || !ScheduledRequest.Request.IsBound())
+		{
+			continue;
+		}
+
+		ScheduledRequest.Request.Execute();
+
+		if (FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) > Budget)
+		{
+			break;
+		}
+	}
+
+	bIsProcessingRequests = false;
+
+	//Drop the processed and cancelled requests at once, keeping the order of the rest.
+	PendingRequests.RemoveAll([](const FScheduledRequest& ScheduledRequest) { return !ScheduledRequest.Request.IsBound(); });
+}
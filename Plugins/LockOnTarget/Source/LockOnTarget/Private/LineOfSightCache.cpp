@@ -0,0 +1,112 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LineOfSightCache.h"
+
+bool FLineOfSightCache::Find(const FLineOfSightQuery& Query, float Time, float MaxAge, float Tolerance, bool& bOutVisible) const
+{
+	const TMap<FKey, FEntry>* const TargetEntries = Entries.Find(MakeTargetKey(Query));
+	const FEntry* const Entry = TargetEntries ? TargetEntries->Find(MakeKey(Query)) : nullptr;
+
+	if (!Entry || (Time - Entry->Time) > MaxAge)
+	{
+		return false;
+	}
+
+	//The query ignores the actor that has blocked another instigator's trace, so it has to be traced again.
+	if (!Entry->bVisible && Entry->BlockingActor && Entry->BlockingActor == Query.IgnoredActor)
+	{
+		return false;
+	}
+
+	const float ToleranceSq = FMath::Square(Tolerance);
+
+	if (FVector::DistSquared(Entry->ViewLocation, Query.ViewLocation) > ToleranceSq || FVector::DistSquared(Entry->TargetLocation, Query.TargetLocation) > ToleranceSq)
+	{
+		return false;
+	}
+
+	bOutVisible = Entry->bVisible;
+	return true;
+}
+
+void FLineOfSightCache::Store(const FLineOfSightQuery& Query, float Time, bool bVisible, const AActor* BlockingActor)
+{
+	FEntry& Entry = Entries.FindOrAdd(MakeTargetKey(Query)).FindOrAdd(MakeKey(Query));
+	Entry.ViewLocation = Query.ViewLocation;
+	Entry.TargetLocation = Query.TargetLocation;
+	Entry.BlockingActor = bVisible ? nullptr : BlockingActor;
+	Entry.Time = Time;
+	Entry.bVisible = bVisible;
+
+	if ((Time - LastPruneTime) > MaxEntryAge)
+	{
+		Prune(Time);
+	}
+}
+
+void FLineOfSightCache::RemoveTarget(const UTargetComponent* Target)
+{
+	FTargetKey TargetKey;
+	TargetKey.Target = Target;
+	Entries.Remove(TargetKey);
+}
+
+void FLineOfSightCache::Reset()
+{
+	Entries.Reset();
+	LastPruneTime = 0.f;
+}
+
+int32 FLineOfSightCache::Num() const
+{
+	int32 OutNum = 0;
+
+	for (const auto& TargetEntries : Entries)
+	{
+		OutNum += TargetEntries.Value.Num();
+	}
+
+	return OutNum;
+}
+
+FLineOfSightCache::FTargetKey FLineOfSightCache::MakeTargetKey(const FLineOfSightQuery& Query)
+{
+	FTargetKey TargetKey;
+	TargetKey.Target = Query.Target;
+	TargetKey.LightweightTarget = Query.LightweightTarget;
+	return TargetKey;
+}
+
+FLineOfSightCache::FKey FLineOfSightCache::MakeKey(const FLineOfSightQuery& Query)
+{
+	FKey Key;
+	Key.Socket = Query.Socket;
+	Key.Channel = static_cast<uint8>(Query.Channel);
+	Key.ViewCell = FIntVector(
+		FMath::FloorToInt32(Query.ViewLocation.X / ViewCellSize),
+		FMath::FloorToInt32(Query.ViewLocation.Y / ViewCellSize),
+		FMath::FloorToInt32(Query.ViewLocation.Z / ViewCellSize));
+
+	return Key;
+}
+
+void FLineOfSightCache::Prune(float Time)
+{
+	LastPruneTime = Time;
+
+	for (auto TargetIt = Entries.CreateIterator(); TargetIt; ++TargetIt)
+	{
+		for (auto It = TargetIt->Value.CreateIterator(); It; ++It)
+		{
+			if ((Time - It->Value.Time) > MaxEntryAge)
+			{
+				It.RemoveCurrent();
+			}
+		}
+
+		if (TargetIt->Value.IsEmpty())
+		{
+			TargetIt.RemoveCurrent();
+		}
+	}
+}
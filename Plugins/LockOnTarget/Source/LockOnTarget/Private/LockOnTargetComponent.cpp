@@ -2,6 +2,8 @@
 
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
+#include "FindTargetScheduler.h"
+#include "TargetManager.h"
 #include "TargetHandlers/TargetHandlerBase.h"
 #include "LockOnTargetDefines.h"
 #include "LockOnTargetExtensions/LockOnTargetExtensionBase.h"
@@ -12,18 +14,30 @@
 #include "Engine/Engine.h"
 #include "Engine/World.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
 
 ULockOnTargetComponent::ULockOnTargetComponent()
 	: bCanCaptureTarget(true)
+	, bScheduleFindTargetRequests(false)
 	, InputBufferThreshold(.08f)
 	, BufferResetFrequency(.2f)
 	, ClampInputVector(-1.f, 1.f)
 	, InputProcessingDelay(0.2f)
 	, bUseInputFreezing(true)
 	, UnfreezeThreshold(1e-2f)
+	, bUseSignificance(false)
+	, SignificanceUpdateInterval(0.5f)
+	, MaxSignificanceTickInterval(0.25f)
+	, MinSignificance(0.1f)
+	, SignificanceDistanceRange(2000.f, 8000.f)
+	, OffScreenSignificanceScale(0.5f)
 	, CurrentTargetInternal(FTargetInfo::NULL_TARGET)
 	, TargetingDuration(0.f)
 	, bIsTargetLocked(false)
+	, Significance(1.f)
+	, SignificanceUpdateTimer(0.f)
+	, BaseTickInterval(0.f)
 	, bInputFrozen(false)
 	, InputBuffer(0.f)
 	, InputVector(0.f)
@@ -40,6 +54,9 @@ void ULockOnTargetComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	//The configured interval isn't overwritten by the significance.
+	BaseTickInterval = PrimaryComponentTick.TickInterval;
+
 	//@TODO: Subscribe on FWorldDelegates::OnWorldBeginTearDown to disable Targeting, instead of checking it manually.
 
 	InitializeSubobject(GetTargetHandler());
@@ -79,6 +96,11 @@ void ULockOnTargetComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
 	if (UWorld* const World = GetWorld())
 	{
 		World->GetTimerManager().ClearAllTimersForObject(this);
+
+		if (World->HasSubsystem<UFindTargetScheduler>())
+		{
+			UFindTargetScheduler::Get(*World).CancelRequest(this);
+		}
 	}
 }
 
@@ -90,6 +112,21 @@ void ULockOnTargetComponent::TickComponent(float DeltaTime, ELevelTick TickType,
 	{
 		TargetingDuration += DeltaTime;
 
+		if (bUseSignificance)
+		{
+			SignificanceUpdateTimer += DeltaTime;
+
+			if (SignificanceUpdateTimer > SignificanceUpdateInterval)
+			{
+				UpdateSignificance();
+			}
+		}
+		else if (Significance < 1.f)
+		{
+			//Disabled by assigning the property directly.
+			SetSignificance(1.f);
+		}
+
 		if (HasAuthorityOverTarget())
 		{
 			ProcessAnalogInput(DeltaTime);
@@ -177,15 +214,133 @@ void ULockOnTargetComponent::RequestFindTarget(const FFindTargetRequestParams& R
 	LOT_SCOPED_EVENT(RequestFindTarget);
 	checkf(HasAuthorityOverTarget(), TEXT("Only the locally controlled owners are able to find a Target."));
 
+	if (ShouldScheduleFindTarget())
+	{
+		UFindTargetScheduler::Get(*GetWorld()).ScheduleRequest(this, FSimpleDelegate::CreateUObject(this, &ULockOnTargetComponent::PerformScheduledFindTarget, RequestParams));
+		return;
+	}
+
 	if (GetTargetHandler())
 	{
-		ProcessTargetHandlerResponse(GetTargetHandler()->FindTarget(RequestParams));
+		//The TargetHandler may complete the request in the next frame.
+		GetTargetHandler()->FindTargetAsync(RequestParams, FOnFindTargetRequestCompleted::CreateUObject(this, &ULockOnTargetComponent::ProcessTargetHandlerResponse));
+	}
+}
+
+void ULockOnTargetComponent::PerformScheduledFindTarget(const FFindTargetRequestParams& RequestParams)
+{
+	LOT_SCOPED_EVENT(PerformScheduledFindTarget);
+
+	//The state might have changed while the request was pending.
+	if (CanCaptureTarget() && GetTargetHandler())
+	{
+		ProcessTargetHandlerResponse(GetTargetHandler()->FindTargetNative(RequestParams));
+	}
+}
+
+bool ULockOnTargetComponent::ShouldScheduleFindTarget() const
+{
+	return bScheduleFindTargetRequests && !IsOwnerPlayerControlled() && GetWorld() && GetWorld()->HasSubsystem<UFindTargetScheduler>();
+}
+
+bool ULockOnTargetComponent::IsOwnerPlayerControlled() const
+{
+	const AController* const Controller = GetOwner() ? GetOwner()->GetInstigatorController() : nullptr;
+	return Controller && Controller->IsPlayerController();
+}
+
+/*******************************************************************************************/
+/*******************************  Significance  ********************************************/
+/*******************************************************************************************/
+
+float ULockOnTargetComponent::GetSignificanceTickInterval() const
+{
+	return MaxSignificanceTickInterval * (1.f - Significance);
+}
+
+void ULockOnTargetComponent::UpdateSignificance()
+{
+	SignificanceUpdateTimer = 0.f;
+
+	//Players always stay at the full rate.
+	const bool bFullSignificance = !bUseSignificance || IsOwnerPlayerControlled();
+	SetSignificance(bFullSignificance ? 1.f : FMath::Clamp(CalculateSignificance(), MinSignificance, 1.f));
+}
+
+void ULockOnTargetComponent::SetUseSignificance(bool bInUseSignificance)
+{
+	if (bUseSignificance != bInUseSignificance)
+	{
+		bUseSignificance = bInUseSignificance;
+
+		//Disabling always restores the full rate, enabling only matters while the Target is locked.
+		if (!bUseSignificance || IsTargetLocked())
+		{
+			UpdateSignificance();
+		}
+	}
+}
+
+void ULockOnTargetComponent::SetSignificance(float InSignificance)
+{
+	//The full significance is applied exactly to restore the configured tick intervals.
+	if (Significance == InSignificance || (InSignificance < 1.f && FMath::IsNearlyEqual(Significance, InSignificance, 0.01f)))
+	{
+		return;
+	}
+
+	Significance = InSignificance;
+	PrimaryComponentTick.UpdateTickIntervalAndCoolDown(FMath::Max(BaseTickInterval, GetSignificanceTickInterval()));
+
+	ForEachSubobject([this](ULockOnTargetExtensionProxy* Extension)
+		{
+			Extension->OnSignificanceChanged(Significance);
+		});
+}
+
+float ULockOnTargetComponent::CalculateSignificance_Implementation() const
+{
+	const AActor* const Owner = GetOwner();
+	const UWorld* const World = GetWorld();
+
+	if (!Owner || !World)
+	{
+		return 1.f;
+	}
+
+	//Distance to the closest player view.
+	float MinDistanceSq = TNumericLimits<float>::Max();
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* const PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			MinDistanceSq = FMath::Min(MinDistanceSq, FVector::DistSquared(ViewLocation, Owner->GetActorLocation()));
+		}
+	}
+
+	float OutSignificance = 1.f;
+
+	if (MinDistanceSq < TNumericLimits<float>::Max())
+	{
+		OutSignificance = FMath::GetMappedRangeValueClamped(SignificanceDistanceRange, FVector2D(1.f, MinSignificance), FMath::Sqrt(MinDistanceSq));
+	}
+
+	//Nothing is rendered on the dedicated server.
+	if (GetNetMode() != NM_DedicatedServer && !Owner->WasRecentlyRendered(0.2f))
+	{
+		OutSignificance *= OffScreenSignificanceScale;
 	}
+
+	return OutSignificance;
 }
 
 void ULockOnTargetComponent::ProcessTargetHandlerResponse(const FFindTargetRequestResponse& Response)
 {
-	const FTargetInfo TargetInfo = Response.Target;
+	const FTargetInfo TargetInfo = PromoteTargetHandlerResponse(Response);
 
 	if (CanTargetBeCaptured(TargetInfo))
 	{
@@ -197,13 +352,35 @@ void ULockOnTargetComponent::ProcessTargetHandlerResponse(const FFindTargetReque
 	}
 }
 
+FTargetInfo ULockOnTargetComponent::PromoteTargetHandlerResponse(const FFindTargetRequestResponse& Response)
+{
+	UWorld* const World = GetWorld();
+
+	if (Response.Target != FTargetInfo::NULL_TARGET || !Response.LightweightTarget.IsSet() || !World)
+	{
+		return Response.Target;
+	}
+
+	LOT_SCOPED_EVENT(PromoteLightweightTarget);
+
+	//The lightweight Target becomes a regular one and is captured by its first Socket.
+	UTargetComponent* const Target = UTargetManager::Get(*World).PromoteLightweightTarget(Response.LightweightTarget);
+
+	if (!Target || Target->GetSockets().IsEmpty())
+	{
+		return FTargetInfo::NULL_TARGET;
+	}
+
+	return { Target, Target->GetSockets()[0] };
+}
+
 void ULockOnTargetComponent::CheckTargetState(float DeltaTime)
 {
 	check(IsTargetLocked() && HasAuthorityOverTarget());
 
 	if (GetTargetHandler())
 	{
-		GetTargetHandler()->CheckTargetState(CurrentTargetInternal, DeltaTime);
+		GetTargetHandler()->CheckTargetStateNative(CurrentTargetInternal, DeltaTime);
 	}
 }
 
@@ -366,6 +543,11 @@ void ULockOnTargetComponent::NotifyTargetCaptured(const FTargetInfo& Target)
 	SetComponentTickEnabled(true);
 	Target->NotifyTargetCaptured(this);
 
+	if (bUseSignificance)
+	{
+		UpdateSignificance();
+	}
+
 	if (HasBegunPlay())
 	{
 		ForEachSubobject([&Target](ULockOnTargetExtensionProxy* Extension)
@@ -439,7 +621,7 @@ void ULockOnTargetComponent::ReceiveTargetException(ETargetExceptionType Excepti
 	{
 		if (IsValid(GetTargetHandler()))
 		{
-			GetTargetHandler()->HandleTargetException(Target, Exception);
+			GetTargetHandler()->HandleTargetExceptionNative(Target, Exception);
 		}
 
 		//If Target is still null, then sync with the server if needed.
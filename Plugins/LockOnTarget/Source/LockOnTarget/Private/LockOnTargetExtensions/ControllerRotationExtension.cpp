@@ -3,6 +3,7 @@
 #include "LockOnTargetExtensions/ControllerRotationExtension.h"
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
+#include "LockOnTargetDefines.h"
 
 #include "GameFramework/Actor.h"
 #include "GameFramework/Controller.h"
@@ -34,6 +35,9 @@ UControllerRotationExtension::UControllerRotationExtension()
 	, InterpEasingExponent(1.25f)
 	, MinInterpSpeed(0.65f)
 	, SpringVelocity(0.f)
+	, bIsCalcRotationOverridden(false)
+	, bIsGetTargetFocusLocationOverridden(false)
+	, bIsGetViewLocationOverridden(false)
 {
 	ExtensionTick.TickGroup = TG_PostPhysics;
 	ExtensionTick.bCanEverTick = true;
@@ -45,21 +49,25 @@ void UControllerRotationExtension::Initialize(ULockOnTargetComponent* Instigator
 {
 	Super::Initialize(Instigator);
 
+	bIsCalcRotationOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UControllerRotationExtension, CalcRotation));
+	bIsGetTargetFocusLocationOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UControllerRotationExtension, GetTargetFocusLocation));
+	bIsGetViewLocationOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UControllerRotationExtension, GetViewLocation));
+
 	//We need to tick before the spring arm component so it can process our result without a 1 frame delay.
 	if (auto* const SpringArmComponent = Instigator->GetOwner()->FindComponentByClass<USpringArmComponent>())
 	{
-		SpringArmComponent->PrimaryComponentTick.AddPrerequisite(this, ExtensionTick);
+		AddUpdateDependent(SpringArmComponent->PrimaryComponentTick);
 	}
 }
 
 void UControllerRotationExtension::Deinitialize(ULockOnTargetComponent* Instigator)
 {
-	Super::Deinitialize(Instigator);
-
 	if (auto* const SpringArmComponent = Instigator->GetOwner()->FindComponentByClass<USpringArmComponent>())
 	{
-		SpringArmComponent->PrimaryComponentTick.RemovePrerequisite(this, ExtensionTick);
+		RemoveUpdateDependent(SpringArmComponent->PrimaryComponentTick);
 	}
+
+	Super::Deinitialize(Instigator);
 }
 
 void UControllerRotationExtension::OnTargetLocked(UTargetComponent* Target, FName Socket)
@@ -110,7 +118,7 @@ void UControllerRotationExtension::Update(float DeltaTime)
 		AController* const Controller = GetInstigatorController();
 		if (Controller && Controller->IsLocalController())
 		{
-			const FRotator Rotation = CalcRotation(Controller, DeltaTime);
+			const FRotator Rotation = LOT_NATIVE_EVENT(bIsCalcRotationOverridden, CalcRotation, Controller, DeltaTime);
 			Controller->SetControlRotation(Rotation);
 		}
 	}
@@ -119,7 +127,7 @@ void UControllerRotationExtension::Update(float DeltaTime)
 FRotator UControllerRotationExtension::CalcRotation_Implementation(const AController* Controller, float DeltaTime)
 {
 	const FRotator CurrentRotation = Controller->GetControlRotation();
-	const FVector InitialTargetLocation = GetTargetFocusLocation();
+	const FVector InitialTargetLocation = LOT_NATIVE_EVENT(bIsGetTargetFocusLocationOverridden, GetTargetFocusLocation);
 	FVector TargetLocation = InitialTargetLocation;
 
 	//TargetLocation Adjustment
@@ -152,7 +160,7 @@ FRotator UControllerRotationExtension::CalcRotation_Implementation(const AContro
 		}
 	}
 
-	const FVector ViewLocation = GetViewLocation(Controller);
+	const FVector ViewLocation = LOT_NATIVE_EVENT(bIsGetViewLocationOverridden, GetViewLocation, Controller);
 	FRotator TargetRotation = GetTargetRotation(ViewLocation, TargetLocation, CurrentRotation);
 	TargetRotation = InterpTargetRotation(TargetRotation, CurrentRotation, DeltaTime);
 
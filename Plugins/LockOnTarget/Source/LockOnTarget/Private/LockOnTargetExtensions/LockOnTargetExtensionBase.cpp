@@ -3,6 +3,7 @@
 #include "LockOnTargetExtensions/LockOnTargetExtensionBase.h"
 #include "LockOnTargetComponent.h"
 #include "LockOnTargetDefines.h"
+#include "ExtensionTickManager.h"
 
 #include "GameFramework/PlayerController.h"
 
@@ -45,8 +46,12 @@ FName FLockOnTargetExtensionTickFunction::DiagnosticContext(bool bDetailed)
  ********************************************************************/
 
 ULockOnTargetExtensionProxy::ULockOnTargetExtensionProxy()
-	: LockOnTargetComponent(nullptr)
+	: bUseBatchedTick(false)
+	, LockOnTargetComponent(nullptr)
 	, bIsInitialized(false)
+	, BatchTick(nullptr)
+	, BatchTickIndex(INDEX_NONE)
+	, BaseTickInterval(0.f)
 {
 	ExtensionTick.TickGroup = TG_DuringPhysics;
 	ExtensionTick.EndTickGroup = TG_PostPhysics;
@@ -68,8 +73,23 @@ void ULockOnTargetExtensionProxy::Initialize(ULockOnTargetComponent* Instigator)
 			if (ExtensionTick.bCanEverTick && !IsTemplate())
 			{
 				ExtensionTick.TargetExtension = this;
-				ExtensionTick.SetTickFunctionEnable(ExtensionTick.bStartWithTickEnabled);
-				ExtensionTick.RegisterTickFunction(InstigatorOwner->GetLevel());
+				BaseTickInterval = ExtensionTick.TickInterval;
+
+				//Extensions with prerequisites keep their own tick function, so the ordering stays per actor.
+				if (bUseBatchedTick && GetWorld() && UExtensionTickManager::CanBatchExtension(this))
+				{
+					UExtensionTickManager::Get(*GetWorld()).RegisterExtension(this);
+
+					if (ExtensionTick.bStartWithTickEnabled)
+					{
+						BatchTick->AddExtension(this);
+					}
+				}
+				else
+				{
+					ExtensionTick.SetTickFunctionEnable(ExtensionTick.bStartWithTickEnabled);
+					ExtensionTick.RegisterTickFunction(InstigatorOwner->GetLevel());
+				}
 			}
 
 			K2_Initialize(Instigator);
@@ -87,6 +107,12 @@ void ULockOnTargetExtensionProxy::Deinitialize(ULockOnTargetComponent* Instigato
 		K2_Deinitialize(Instigator);
 		LockOnTargetComponent = nullptr;
 
+		//The batch is only reached through the manager. The reference is cleared if the manager has been deinitialized on the world teardown.
+		if (BatchTick)
+		{
+			UExtensionTickManager::Get(*Instigator->GetWorld()).UnregisterExtension(this);
+		}
+
 		if (ExtensionTick.IsTickFunctionRegistered())
 		{
 			ExtensionTick.UnRegisterTickFunction();
@@ -98,10 +124,35 @@ void ULockOnTargetExtensionProxy::SetTickEnabled(bool bInTickEnabled)
 {
 	if (IsInitialized() && ExtensionTick.bCanEverTick)
 	{
-		ExtensionTick.SetTickFunctionEnable(bInTickEnabled);
+		if (!BatchTick)
+		{
+			ExtensionTick.SetTickFunctionEnable(bInTickEnabled);
+		}
+		else if (bInTickEnabled != IsTickEnabled())
+		{
+			bInTickEnabled ? BatchTick->AddExtension(this) : BatchTick->RemoveExtension(this);
+		}
 	}
 }
 
+FTickFunction& ULockOnTargetExtensionProxy::GetUpdateTickFunction()
+{
+	return BatchTick ? static_cast<FTickFunction&>(*BatchTick) : static_cast<FTickFunction&>(ExtensionTick);
+}
+
+void ULockOnTargetExtensionProxy::AddUpdateDependent(FTickFunction& Dependent)
+{
+	//The batched tick function is owned by the UExtensionTickManager.
+	UObject* const PrerequisiteObject = BatchTick ? static_cast<UObject*>(&UExtensionTickManager::Get(*GetWorld())) : this;
+	Dependent.AddPrerequisite(PrerequisiteObject, GetUpdateTickFunction());
+}
+
+void ULockOnTargetExtensionProxy::RemoveUpdateDependent(FTickFunction& Dependent)
+{
+	UObject* const PrerequisiteObject = BatchTick ? static_cast<UObject*>(&UExtensionTickManager::Get(*GetWorld())) : this;
+	Dependent.RemovePrerequisite(PrerequisiteObject, GetUpdateTickFunction());
+}
+
 UWorld* ULockOnTargetExtensionProxy::GetWorld() const
 {
 	return (IsValid(GetOuter()) && (!GIsEditor || GIsPlayInEditorWorld)) ? GetOuter()->GetWorld() : nullptr;
@@ -150,6 +201,24 @@ void ULockOnTargetExtensionProxy::OnTargetNotFound(bool bIsTargetLocked)
 	K2_OnTargetNotFound(bIsTargetLocked);
 }
 
+void ULockOnTargetExtensionProxy::OnSignificanceChanged(float Significance)
+{
+	if (IsInitialized() && ExtensionTick.bCanEverTick)
+	{
+		const float TickInterval = FMath::Max(BaseTickInterval, GetLockOnTargetComponent()->GetSignificanceTickInterval());
+
+		//The batched tick reads the interval directly.
+		if (BatchTick)
+		{
+			ExtensionTick.TickInterval = TickInterval;
+		}
+		else
+		{
+			ExtensionTick.UpdateTickIntervalAndCoolDown(TickInterval);
+		}
+	}
+}
+
 void ULockOnTargetExtensionProxy::Update(float DeltaTime)
 {
 	K2_Update(DeltaTime);
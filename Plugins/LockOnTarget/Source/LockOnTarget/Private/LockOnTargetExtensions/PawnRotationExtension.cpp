@@ -23,18 +23,18 @@ void UPawnRotationExtension::Initialize(ULockOnTargetComponent* Instigator)
 	//Tick before the movement component.
 	if (UPawnMovementComponent* const MovementComponent = GetMovementComponent())
 	{
-		MovementComponent->PrimaryComponentTick.AddPrerequisite(this, ExtensionTick);
+		AddUpdateDependent(MovementComponent->PrimaryComponentTick);
 	}
 }
 
 void UPawnRotationExtension::Deinitialize(ULockOnTargetComponent* Instigator)
 {
-	Super::Deinitialize(Instigator);
-
 	if (UPawnMovementComponent* const MovementComponent = GetMovementComponent())
 	{
-		MovementComponent->PrimaryComponentTick.RemovePrerequisite(this, ExtensionTick);
+		RemoveUpdateDependent(MovementComponent->PrimaryComponentTick);
 	}
+
+	Super::Deinitialize(Instigator);
 }
 
 void UPawnRotationExtension::OnTargetLocked(UTargetComponent* Target, FName Socket)
@@ -14,6 +14,7 @@
 UTargetPreviewExtension::UTargetPreviewExtension()
 	: WidgetClass(FSoftClassPath(FString(TEXT("/Script/UMGEditor.WidgetBlueprint'/LockOnTarget/WBP_PreviewTarget.WBP_PreviewTarget_C'"))))
 	, UpdateRate(0.1f)
+	, bUseIncrementalUpdate(true)
 	, Widget(nullptr)
 	, bWidgetIsInitialized(false)
 {
@@ -144,7 +145,7 @@ void UTargetPreviewExtension::UpdateTargetPreview()
 
 	if (UTargetHandlerBase* const TargetHandler = Owner->GetTargetHandler())
 	{
-		const FFindTargetRequestResponse Response = TargetHandler->FindTarget();
+		const FFindTargetRequestResponse Response = bUseIncrementalUpdate ? TargetHandler->FindTargetIncremental(FFindTargetRequestParams()) : TargetHandler->FindTargetNative();
 		const FTargetInfo Preview = Response.Target;
 
 		if (Owner->IsTargetValid(Preview.TargetComponent))
@@ -10,15 +10,24 @@
 UTargetComponent::UTargetComponent()
 	: bCanBeCaptured(true)
 	, AssociatedComponentName(NAME_None)
+	, TargetingChannels(static_cast<uint8>(ETargetingChannel::Default))
 	, bForceCustomCaptureRadius(false)
 	, CustomCaptureRadius(2700.f)
 	, Priority(0.5)
+	, bCacheSocketLocations(false)
 	, FocusPointType(ETargetFocusPointType::CapturedSocket)
 	, FocusPointCustomSocket(NAME_None)
 	, FocusPointRelativeOffset(0.f)
 	, bWantsDisplayWidget(true)
 	, WidgetRelativeOffset(0.f)
 	, AssociatedComponent(nullptr)
+	, LastSocketIndex(INDEX_NONE)
+	, CachedFocusPointLocation(0.f)
+	, CachedFocusPointFrame(MAX_uint64)
+	, CachedFocusPointInstigator(nullptr)
+	, CachedFocusPointType(ETargetFocusPointType::CapturedSocket)
+	, CachedFocusPointSocket(NAME_None)
+	, bIsGetCustomFocusPointOverridden(false)
 {
 	PrimaryComponentTick.bCanEverTick = false;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
@@ -36,6 +45,8 @@ void UTargetComponent::InitializeComponent()
 {
 	Super::InitializeComponent();
 
+	bIsGetCustomFocusPointOverridden = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UTargetComponent, GetCustomFocusPoint));
+
 	//If the associated component isn't set yet or changed from details.
 	if (!AssociatedComponent.IsValid() || AssociatedComponent->GetFName() != AssociatedComponentName)
 	{
@@ -60,6 +71,13 @@ void UTargetComponent::SetAssociatedComponent(USceneComponent* InAssociatedCompo
 		check(!InAssociatedComponent->IsEditorOnly());
 		AssociatedComponent = InAssociatedComponent;
 		AssociatedComponentName = InAssociatedComponent->GetFName(); //For proper display in details.
+		ResetSocketLocationsCache();
+
+		//The TargetManager watches the associated component movement.
+		if (HasBegunPlay())
+		{
+			GetTargetManager().RefreshTarget(this);
+		}
 	}
 }
 
@@ -103,6 +121,20 @@ void UTargetComponent::SetCanBeCaptured(bool bInCanBeCaptured)
 	}
 }
 
+void UTargetComponent::SetTargetingChannels(uint8 InTargetingChannels)
+{
+	if (TargetingChannels != InTargetingChannels)
+	{
+		TargetingChannels = InTargetingChannels;
+
+		//Targets are partitioned by channels in the TargetManager.
+		if (HasBegunPlay())
+		{
+			GetTargetManager().RefreshTarget(this);
+		}
+	}
+}
+
 void UTargetComponent::NotifyTargetCaptured(ULockOnTargetComponent* Instigator)
 {
 	check(IsValid(Instigator) && Instigator->GetTargetComponent() == this);
@@ -138,19 +170,80 @@ void UTargetComponent::DispatchTargetException(ETargetExceptionType Exception)
 }
 
 FVector UTargetComponent::GetSocketLocation(FName Socket) const
+{
+	if (bCacheSocketLocations)
+	{
+		const int32 SocketIndex = FindSocketIndex(Socket);
+
+		if (SocketIndex != INDEX_NONE)
+		{
+			return GetSocketLocationByIndex(SocketIndex);
+		}
+	}
+
+	return EvaluateSocketLocation(Socket);
+}
+
+FVector UTargetComponent::GetSocketLocationByIndex(int32 SocketIndex) const
+{
+	check(Sockets.IsValidIndex(SocketIndex));
+
+	if (!bCacheSocketLocations)
+	{
+		return EvaluateSocketLocation(Sockets[SocketIndex]);
+	}
+
+	if (CachedSocketLocations.Num() != Sockets.Num())
+	{
+		CachedSocketLocations.SetNumUninitialized(Sockets.Num());
+		CachedSocketFrames.Init(MAX_uint64, Sockets.Num());
+	}
+
+	if (CachedSocketFrames[SocketIndex] != GFrameCounter)
+	{
+		CachedSocketLocations[SocketIndex] = EvaluateSocketLocation(Sockets[SocketIndex]);
+		CachedSocketFrames[SocketIndex] = GFrameCounter;
+	}
+
+	return CachedSocketLocations[SocketIndex];
+}
+
+int32 UTargetComponent::FindSocketIndex(FName Socket) const
+{
+	if (!Sockets.IsValidIndex(LastSocketIndex) || Sockets[LastSocketIndex] != Socket)
+	{
+		LastSocketIndex = Sockets.Find(Socket);
+	}
+
+	return LastSocketIndex;
+}
+
+FVector UTargetComponent::EvaluateSocketLocation(FName Socket) const
 {
 	return AssociatedComponent.IsValid() ? AssociatedComponent->GetSocketLocation(Socket) : GetOwner()->GetActorLocation();
 }
 
+void UTargetComponent::ResetSocketLocationsCache()
+{
+	CachedSocketLocations.Reset();
+	CachedSocketFrames.Reset();
+	LastSocketIndex = INDEX_NONE;
+	CachedFocusPointFrame = MAX_uint64;
+	CachedFocusPointInstigator = nullptr;
+	CachedFocusPointSocket = NAME_None;
+}
+
 void UTargetComponent::SetDefaultSocket(FName Socket)
 {
 	if (Sockets.IsEmpty())
 	{
 		Sockets.Add(Socket);
+		NotifySocketsChanged();
 	}
 	else if (Sockets[0] != Socket)
 	{
 		Sockets[0] = Socket;
+		NotifySocketsChanged();
 
 		DispatchTargetException(ETargetExceptionType::SocketInvalidation);
 	}
@@ -163,6 +256,7 @@ bool UTargetComponent::AddSocket(FName Socket)
 	if (bIsSuccessful)
 	{
 		Sockets.Add(Socket);
+		NotifySocketsChanged();
 	}
 
 	return bIsSuccessful;
@@ -174,36 +268,72 @@ bool UTargetComponent::RemoveSocket(FName Socket)
 
 	if (bIsSuccessful)
 	{
+		NotifySocketsChanged();
 		DispatchTargetException(ETargetExceptionType::SocketInvalidation);
 	}
 
 	return bIsSuccessful;
 }
 
+void UTargetComponent::NotifySocketsChanged()
+{
+	ResetSocketLocationsCache();
+
+	//Sockets are cached in the TargetManager snapshot.
+	if (HasBegunPlay())
+	{
+		GetTargetManager().InvalidateTargetData();
+	}
+}
+
 FVector UTargetComponent::GetFocusPointLocation(const ULockOnTargetComponent* Instigator) const
 {
 	check(IsValid(Instigator) && GetOwner());
-	FVector FocusPointLocation{ 0.f };
 
-	switch (FocusPointType)
-	{
-	case ETargetFocusPointType::CapturedSocket:
-		FocusPointLocation = GetSocketLocation(Instigator->GetCapturedSocket());
-		break;
+	//The cache is keyed on everything the base location depends on, so switching the captured Socket
+	//or changing the FocusPoint settings within a frame doesn't return a stale location.
+	const FName FocusPointSocket = FocusPointType == ETargetFocusPointType::CapturedSocket ? Instigator->GetCapturedSocket()
+		: FocusPointType == ETargetFocusPointType::CustomSocket ? FocusPointCustomSocket : NAME_None;
 
-	case ETargetFocusPointType::CustomSocket:
-		FocusPointLocation = GetSocketLocation(FocusPointCustomSocket);
-		break;
+	FVector FocusPointLocation{ 0.f };
 
-	case ETargetFocusPointType::Custom:
-		FocusPointLocation = GetCustomFocusPoint(Instigator);
-		break;
+	if (bCacheSocketLocations
+		&& CachedFocusPointFrame == GFrameCounter
+		&& CachedFocusPointInstigator == Instigator
+		&& CachedFocusPointType == FocusPointType
+		&& CachedFocusPointSocket == FocusPointSocket)
+	{
+		FocusPointLocation = CachedFocusPointLocation;
+	}
+	else
+	{
+		switch (FocusPointType)
+		{
+		case ETargetFocusPointType::CapturedSocket:
+		case ETargetFocusPointType::CustomSocket:
+			FocusPointLocation = GetSocketLocation(FocusPointSocket);
+			break;
+
+		case ETargetFocusPointType::Custom:
+			FocusPointLocation = LOT_NATIVE_EVENT(bIsGetCustomFocusPointOverridden, GetCustomFocusPoint, Instigator);
+			break;
+
+		default:
+			checkNoEntry();
+			break;
+		}
 
-	default:
-		checkNoEntry();
-		break;
+		if (bCacheSocketLocations)
+		{
+			CachedFocusPointLocation = FocusPointLocation;
+			CachedFocusPointFrame = GFrameCounter;
+			CachedFocusPointInstigator = Instigator;
+			CachedFocusPointType = FocusPointType;
+			CachedFocusPointSocket = FocusPointSocket;
+		}
 	}
 
+	//The offset is applied on top of the cached location to reflect its changes immediately.
 	if (!FocusPointRelativeOffset.IsNearlyZero())
 	{
 		FocusPointLocation += GetOwner()->GetActorTransform().TransformVectorNoScale(FocusPointRelativeOffset);
@@ -5,16 +5,54 @@
 #include "LockOnTargetComponent.h"
 
 UTargetHandlerBase::UTargetHandlerBase()
+	: bIsFindTargetOverridden(false)
+	, bIsCheckTargetStateOverridden(false)
+	, bIsHandleTargetExceptionOverridden(false)
 {
 	//Do something.
 }
 
+void UTargetHandlerBase::Initialize(ULockOnTargetComponent* Instigator)
+{
+	Super::Initialize(Instigator);
+
+	bIsFindTargetOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UTargetHandlerBase, FindTarget));
+	bIsCheckTargetStateOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UTargetHandlerBase, CheckTargetState));
+	bIsHandleTargetExceptionOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UTargetHandlerBase, HandleTargetException));
+}
+
+FFindTargetRequestResponse UTargetHandlerBase::FindTargetNative(const FFindTargetRequestParams& RequestParams)
+{
+	return LOT_NATIVE_EVENT(bIsFindTargetOverridden, FindTarget, RequestParams);
+}
+
+void UTargetHandlerBase::CheckTargetStateNative(const FTargetInfo& Target, float DeltaTime)
+{
+	LOT_NATIVE_EVENT(bIsCheckTargetStateOverridden, CheckTargetState, Target, DeltaTime);
+}
+
+void UTargetHandlerBase::HandleTargetExceptionNative(const FTargetInfo& Target, ETargetExceptionType Exception)
+{
+	LOT_NATIVE_EVENT(bIsHandleTargetExceptionOverridden, HandleTargetException, Target, Exception);
+}
+
 FFindTargetRequestResponse UTargetHandlerBase::FindTarget_Implementation(const FFindTargetRequestParams& RequestParams)
 {
 	LOG_WARNING("Unimplemented method is called. NULL_TARGET is returned.");
 	return FFindTargetRequestResponse();
 }
 
+FFindTargetRequestResponse UTargetHandlerBase::FindTargetIncremental(const FFindTargetRequestParams& RequestParams)
+{
+	return FindTargetNative(RequestParams);
+}
+
+void UTargetHandlerBase::FindTargetAsync(const FFindTargetRequestParams& RequestParams, FOnFindTargetRequestCompleted&& OnCompleted)
+{
+	const FFindTargetRequestResponse Response = FindTargetNative(RequestParams);
+	OnCompleted.ExecuteIfBound(Response);
+}
+
 void UTargetHandlerBase::CheckTargetState_Implementation(const FTargetInfo& Target, float DeltaTime)
 {
 	//Optional.
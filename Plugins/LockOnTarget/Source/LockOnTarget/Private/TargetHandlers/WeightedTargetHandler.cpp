@@ -1,16 +1,21 @@
 // Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
 
 #include "TargetHandlers/WeightedTargetHandler.h"
+#include "WeightedTargetSolver.h"
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
 #include "TargetManager.h"
+#include "FindTargetScheduler.h"
 #include "LockOnTargetDefines.h"
 
 #include "CollisionQueryParams.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
 #include "TimerManager.h"
-#include "Blueprint/WidgetLayoutLibrary.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+#include "Math/VectorRegister.h"
 
 UWeightedTargetHandler::UWeightedTargetHandler()
 	: AutoFindTargetFlags(0b00011111)
@@ -22,11 +27,14 @@ UWeightedTargetHandler::UWeightedTargetHandler()
 	, DistanceMaxFactor(2420.f)
 	, DeltaAngleMaxFactor(45.f)
 	, MinimumFactorThreshold(0.035f)
+	, MaxExpandedTargets(8)
+	, TargetableChannels(static_cast<uint8>(ETargetingChannel::All))
 	, bDistanceCheck(true)
 	, DefaultCaptureRadius(2200.f)
 	, LostRadiusScale(1.1f)
 	, NearClipRadius(150.f)
 	, CaptureRadiusScale(1.f)
+	, bEventDrivenDistanceCheck(false)
 	, ViewConeAngle(42.f)
 	, ViewPitchOffset(10.f)
 	, ViewYawOffset(0.f)
@@ -35,35 +43,200 @@ UWeightedTargetHandler::UWeightedTargetHandler()
 	, bRecentRenderCheck(true)
 	, RecentTolerance(0.1f)
 	, PlayerInputAngularRange(60.f)
+	, bPrecomputeSwitchTargets(false)
+	, SwitchSectorsNum(8)
+	, SwitchTargetsPerFrame(8)
+	, SwitchSectorsUpdateInterval(0.2f)
+	, SwitchSectorsViewAngleTolerance(5.f)
+	, SwitchSectorsMaxAge(0.5f)
 	, bLineOfSightCheck(true)
 	, TraceCollisionChannel(ECollisionChannel::ECC_Visibility)
 	, LostTargetDelay(3.f)
 	, CheckInterval(0.2f)
+	, bAdaptiveCheckInterval(false)
+	, MaxCheckInterval(0.6f)
+	, AdaptiveAngularSpeed(90.f)
+	, AdaptiveStableTime(2.f)
+	, bAsyncLineOfSightCheck(true)
+	, SpeculativeLineOfSightCandidates(4)
+	, LineOfSightCacheDuration(0.2f)
+	, LineOfSightCacheTolerance(20.f)
+	, bAsyncFindTarget(false)
+	, bFindLightweightTargets(false)
+	, MaxLightweightLineOfSightTraces(4)
+	, IncrementalViewTolerance(10.f)
+	, IncrementalViewAngleTolerance(1.f)
+	, IncrementalTargetTolerance(10.f)
+	, IncrementalFullUpdateInterval(1.f)
+	, IncrementalHysteresis(0.15f)
 	, LineOfSightCheckTimer(0.f)
+	, AdaptiveCheckInterval(0.f)
+	, LastLineOfSightTime(0.f)
+	, LineOfSightResultTime(0.f)
+	, LastLineOfSightDirection(FVector::ZeroVector)
+	, bLastLineOfSightVisible(true)
+	, bIsCalculateTargetWeightOverridden(false)
+	, bIsShouldSkipTargetCustomOverridden(false)
+	, bIsGetPointOfViewOverridden(false)
+	, SwitchSectorsUpdateTime(0.f)
+	, PendingSwitchSectorsTime(-FLT_MAX)
+	, PendingSwitchSectorsViewDirection(FVector::ForwardVector)
+	, bBuildingSwitchSectors(false)
+	, DetailedResponseBuffer(nullptr)
+	, IncrementalViewLocation(FVector::ZeroVector)
+	, IncrementalViewDirection(FVector::ForwardVector)
+	, IncrementalFullUpdateTime(-FLT_MAX)
+	, IncrementalTargetsVersion(0)
 {
 	ExtensionTick.bCanEverTick = false;
 }
 
+void UWeightedTargetHandler::Initialize(ULockOnTargetComponent* Instigator)
+{
+	Super::Initialize(Instigator);
+
+	//Blueprint overrides can only be dispatched per Target.
+	bIsCalculateTargetWeightOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UWeightedTargetHandler, CalculateTargetWeight));
+	bIsShouldSkipTargetCustomOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UWeightedTargetHandler, ShouldSkipTargetCustom));
+	bIsGetPointOfViewOverridden = IsEventOverriddenInBlueprint(GET_FUNCTION_NAME_CHECKED(UWeightedTargetHandler, GetPointOfView));
+}
+
+void UWeightedTargetHandler::Deinitialize(ULockOnTargetComponent* Instigator)
+{
+	CancelPendingFindTarget();
+
+	UWorld* const World = GetWorld();
+
+	if (World && World->HasSubsystem<UTargetManager>())
+	{
+		UTargetManager::Get(*World).UnwatchLockedTarget(this);
+	}
+
+	Super::Deinitialize(Instigator);
+}
+
 FFindTargetRequestResponse UWeightedTargetHandler::FindTarget_Implementation(const FFindTargetRequestParams& RequestParams)
 {
 	const EFindTargetContextMode ContextMode = GetLockOnTargetComponent()->IsTargetLocked() ? EFindTargetContextMode::Switch : EFindTargetContextMode::Find;
 	FFindTargetContext Context = CreateFindTargetContext(ContextMode, RequestParams);
+
+	if (ContextMode == EFindTargetContextMode::Switch)
+	{
+		const FTargetInfo SwitchTarget = FindPrecomputedSwitchTarget(Context);
+
+		if (SwitchTarget != FTargetInfo::NULL_TARGET)
+		{
+			FFindTargetRequestResponse Response;
+			Response.Target = SwitchTarget;
+			return Response;
+		}
+	}
+
 	return FindTargetBatched(Context);
 }
 
+FFindTargetRequestResponse UWeightedTargetHandler::FindTargetDetailed(FWeightedDetailedResponseData& OutDetailedResponse, FFindTargetRequestParams RequestParams)
+{
+	OutDetailedResponse.TargetsData.Reset();
+	RequestParams.bGenerateDetailedResponse = true;
+
+	//Nested requests, e.g. from the Blueprint override, fall back to the payload object once the buffer is consumed.
+	TGuardValue<FWeightedDetailedResponseData*> BufferGuard(DetailedResponseBuffer, &OutDetailedResponse);
+	return FindTarget(RequestParams);
+}
+
+void UWeightedTargetHandler::FindTargetAsync(const FFindTargetRequestParams& RequestParams, FOnFindTargetRequestCompleted&& OnCompleted)
+{
+	//The newer request supersedes the pending one.
+	CancelPendingFindTarget();
+
+	if (!CanFindTargetOffGameThread(RequestParams) && !CanTraceSpeculatively(RequestParams))
+	{
+		Super::FindTargetAsync(RequestParams, MoveTemp(OnCompleted));
+		return;
+	}
+
+	const EFindTargetContextMode ContextMode = GetLockOnTargetComponent()->IsTargetLocked() ? EFindTargetContextMode::Switch : EFindTargetContextMode::Find;
+	FFindTargetContext Context = CreateFindTargetContext(ContextMode, RequestParams);
+
+	//Same as FindTarget(), the precomputed switch Target is returned immediately.
+	if (ContextMode == EFindTargetContextMode::Switch)
+	{
+		const FTargetInfo SwitchTarget = FindPrecomputedSwitchTarget(Context);
+
+		if (SwitchTarget != FTargetInfo::NULL_TARGET)
+		{
+			FFindTargetRequestResponse Response;
+			Response.Target = SwitchTarget;
+			OnCompleted.ExecuteIfBound(Response);
+			return;
+		}
+	}
+
+	if (!CanFindTargetOffGameThread(RequestParams))
+	{
+		//Only the line of sight traces are async.
+		TArray<FTargetContext> TargetsData;
+		FTargetHandle LightweightTarget;
+		GatherWeightedCandidates(Context, /*out*/TargetsData, LightweightTarget);
+
+		{
+			LOT_SCOPED_EVENT(WTH_Pass_Sort);
+			TargetsData.Heapify([](const FTargetContext& lhs, const FTargetContext& rhs) { return lhs.Weight < rhs.Weight; });
+		}
+
+		PerformSpeculativeSecondaryPass(Context, /*in*/TargetsData, LightweightTarget, MoveTemp(OnCompleted));
+		return;
+	}
+
+	LOT_SCOPED_EVENT(WTH_LaunchFindTargetTask);
+
+	const TSharedRef<FWeightedFindTargetTask> Task = MakeShared<FWeightedFindTargetTask>();
+	Task->Context = MoveTemp(Context);
+	CaptureFindTargetTask(*Task);
+
+	PendingFindTargetData = Task;
+	PendingFindTargetCallback = MoveTemp(OnCompleted);
+
+	//The worker only touches the plain data of the task.
+	PendingFindTargetTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Task]()
+		{
+			PerformFindTargetTask(*Task);
+		});
+
+	//The response is applied in the next frame, so the latency stays within one frame.
+	GetWorld()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &UWeightedTargetHandler::CompletePendingFindTarget));
+}
+
+FFindTargetRequestResponse UWeightedTargetHandler::FindTargetIncremental(const FFindTargetRequestParams& RequestParams)
+{
+	//Switching and custom weights aren't incremental.
+	if (IsFindTargetOverridden() || !CanUseBatchSolver() || RequestParams.bGenerateDetailedResponse || GetLockOnTargetComponent()->IsTargetLocked())
+	{
+		return FindTarget(RequestParams);
+	}
+
+	FFindTargetContext Context = CreateFindTargetContext(EFindTargetContextMode::Find, RequestParams);
+	return FindTargetIncrementalBatched(Context);
+}
+
 void UWeightedTargetHandler::CheckTargetState_Implementation(const FTargetInfo& Target, float DeltaTime)
 {
 	LOT_SCOPED_EVENT(WTH_CheckTargetState);
 
 	FVector ViewLocation;
 	FRotator ViewRotation;
-	GetPointOfView(ViewLocation, ViewRotation);
+	LOT_NATIVE_EVENT(bIsGetPointOfViewOverridden, GetPointOfView, ViewLocation, ViewRotation);
 
 	const AActor* const TargetActor = Target->GetOwner();
+	FTargetSnapshot& Snapshot = UTargetManager::Get(*GetWorld()).GetTargetSnapshot();
+	const int32 TargetIndex = Snapshot.FindTargetIndex(Target.TargetComponent);
 
-	if (bDistanceCheck)
+	//Otherwise the TargetManager notifies about the radius exit.
+	if (bDistanceCheck && !bEventDrivenDistanceCheck)
 	{
-		const float DistanceSq = (TargetActor->GetActorLocation() - ViewLocation).SizeSquared();
+		const FVector TargetLocation = TargetIndex != INDEX_NONE ? Snapshot.GetActorLocation(TargetIndex) : TargetActor->GetActorLocation();
+		const float DistanceSq = (TargetLocation - ViewLocation).SizeSquared();
 		const float TargetLostRadius = GetTargetCaptureRadius(Target.TargetComponent) * LostRadiusScale;
 
 		if (DistanceSq > FMath::Square(TargetLostRadius))
@@ -73,23 +246,38 @@ void UWeightedTargetHandler::CheckTargetState_Implementation(const FTargetInfo&
 		}
 	}
 
+	if (bPrecomputeSwitchTargets)
+	{
+		UpdateSwitchSectors(ViewRotation);
+	}
+
 	if (bLineOfSightCheck && LostTargetDelay > 0.f)
 	{
 		LineOfSightCheckTimer += DeltaTime;
 
-		if (LineOfSightCheckTimer > CheckInterval)
+		//Insignificant instigators already tick less often, so the interval isn't scaled by the significance again.
+		if (LineOfSightCheckTimer > GetLineOfSightCheckInterval())
 		{
 			LineOfSightCheckTimer = 0.f;
+			const FVector SocketLocation = TargetIndex != INDEX_NONE ? Snapshot.GetSocketLocation(TargetIndex, Target.Socket) : Target->GetSocketLocation(Target.Socket);
+			const FLineOfSightQuery Query = MakeLineOfSightQuery(ViewLocation, Target, SocketLocation);
+			bool bIsVisible = false;
 
-			//@TODO: Maybe use AsyncLineTrace.
-			if (LineOfSightTrace(ViewLocation, Target->GetSocketLocation(Target.Socket), TargetActor))
-			{
-				StopLineOfSightTimer();
-			}
-			else
+			if (!FindCachedLineOfSight(Query, bIsVisible))
 			{
-				StartLineOfSightTimer();
+				if (bAsyncLineOfSightCheck)
+				{
+					//The timer is updated once the trace is done.
+					AsyncLineOfSightTrace(Query, TargetActor);
+					return;
+				}
+
+				const AActor* BlockingActor = nullptr;
+				bIsVisible = LineOfSightTrace(ViewLocation, SocketLocation, TargetActor, &BlockingActor);
+				CacheLineOfSight(Query, bIsVisible, BlockingActor);
 			}
+
+			ApplyLineOfSightResult(Query, bIsVisible);
 		}
 	}
 }
@@ -99,11 +287,33 @@ void UWeightedTargetHandler::HandleTargetException_Implementation(const FTargetI
 	HandleTargetUnlock(ConvertTargetExceptionToUnlockReason(Exception));
 }
 
+void UWeightedTargetHandler::OnTargetLocked(UTargetComponent* Target, FName Socket)
+{
+	Super::OnTargetLocked(Target, Socket);
+	ResetIncrementalState();
+	ResetSwitchSectors();
+	ResetAdaptiveLineOfSight();
+
+	//The Target state is only checked by the authority.
+	if (bDistanceCheck && bEventDrivenDistanceCheck && GetLockOnTargetComponent()->HasAuthorityOverTarget())
+	{
+		UTargetManager::Get(*GetWorld()).WatchLockedTarget(this, GetLockOnTargetComponent()->GetOwner(), Target, GetTargetCaptureRadius(Target) * LostRadiusScale,
+			FLockedTargetViewLocation::CreateUObject(this, &UWeightedTargetHandler::GetDistanceCheckViewLocation),
+			FSimpleDelegate::CreateUObject(this, &UWeightedTargetHandler::OnCapturedTargetLeftRadius));
+	}
+}
+
 void UWeightedTargetHandler::OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Socket)
 {
 	Super::OnTargetUnlocked(UnlockedTarget, Socket);
+	ResetIncrementalState();
+	ResetSwitchSectors();
 	StopLineOfSightTimer();
+	UTargetManager::Get(*GetWorld()).UnwatchLockedTarget(this);
 	LineOfSightCheckTimer = 0.f;
+
+	//The result of the pending trace belongs to the unlocked Target.
+	PendingLineOfSightTrace = FTraceHandle();
 }
 
 /*******************************************************************************************/
@@ -115,26 +325,32 @@ FFindTargetRequestResponse UWeightedTargetHandler::FindTargetBatched(FFindTarget
 	LOT_SCOPED_EVENT(WTH_BatchedFinding);
 
 	FFindTargetRequestResponse OutResponse;
-	TArray<FTargetContext> TargetsData;
 
-	{
-		LOT_SCOPED_EVENT(WTH_Pass_PrimarySampling);
-		PerformPrimarySamplingPass(Context, /*out*/TargetsData);
-	}
+	//The scratch buffer keeps its capacity between requests. A nested request just allocates a new one.
+	TArray<FTargetContext> TargetsData = MoveTemp(TargetsDataScratch);
+
+	FTargetHandle LightweightTarget;
+	GatherWeightedCandidates(Context, /*out*/TargetsData, LightweightTarget);
 
 	if (TargetsData.Num() > 0)
 	{
-		{
-			LOT_SCOPED_EVENT(WTH_Pass_Solver);
-			PerformSolverPass(Context, /*inout*/TargetsData);
-		}
-
 		{
 			LOT_SCOPED_EVENT(WTH_Pass_Sort);
-			TargetsData.Sort([](const auto& lhs, const auto& rhs)
+
+			auto WeightPredicate = [](const FTargetContext& lhs, const FTargetContext& rhs)
 				{
 					return lhs.Weight < rhs.Weight;
-				});
+				};
+
+			//The ranked list is only needed for the detailed response. Otherwise candidates are lazily popped from the heap.
+			if (Context.RequestParams.bGenerateDetailedResponse)
+			{
+				TargetsData.Sort(WeightPredicate);
+			}
+			else
+			{
+				TargetsData.Heapify(WeightPredicate);
+			}
 		}
 
 		{
@@ -143,69 +359,234 @@ FFindTargetRequestResponse UWeightedTargetHandler::FindTargetBatched(FFindTarget
 		}
 	}
 
+	//The lightweight Target is promoted only once it's captured.
+	if (OutResponse.Target == FTargetInfo::NULL_TARGET)
+	{
+		OutResponse.LightweightTarget = LightweightTarget;
+	}
+
+	TargetsData.Reset();
+	TargetsDataScratch = MoveTemp(TargetsData);
+
 	return OutResponse;
 }
 
+void UWeightedTargetHandler::GatherWeightedCandidates(FFindTargetContext& Context, TArray<FTargetContext>& OutTargetsData, FTargetHandle& OutLightweightTarget)
+{
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_PrimarySampling);
+		PerformPrimarySamplingPass(Context, /*out*/OutTargetsData);
+	}
+
+	if (bScreenCapture)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_ScreenCulling);
+		PerformScreenCullingPass(Context, /*inout*/OutTargetsData);
+	}
+
+	if (OutTargetsData.Num() > 0)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_Solver);
+		PerformSolverPass(Context, /*inout*/OutTargetsData);
+	}
+
+	FilterByLightweightTarget(Context, /*inout*/OutTargetsData, OutLightweightTarget);
+}
+
 void UWeightedTargetHandler::PerformPrimarySamplingPass(FFindTargetContext& Context, TArray<FTargetContext>& OutTargetsData)
 {
-	const TSet<UTargetComponent*>& RegisteredTargets = UTargetManager::Get(*GetWorld()).GetRegisteredTargets();
+	FTargetSnapshot& Snapshot = UTargetManager::Get(*GetWorld()).GetTargetSnapshot();
+	TArray<int32> TargetIndices;
+	GatherPrimaryCandidates(Context, Snapshot, TargetIndices);
+
+	TargetIndices.RemoveAllSwap([&](int32 TargetIndex)
+		{
+			return ShouldSkipTargetPrimaryPass(Context, Snapshot, TargetIndex);
+		}, false);
+
+	//Custom weights can only be calculated per Socket.
+	if (MaxExpandedTargets > 0 && TargetIndices.Num() > MaxExpandedTargets && CanUseBatchSolver())
+	{
+		SelectTargetsToExpand(Context, Snapshot, TargetIndices);
+	}
+
+	OutTargetsData.Reset();
+	OutTargetsData.Reserve(TargetIndices.Num());
+
+	for (const int32 TargetIndex : TargetIndices)
+	{
+		ExpandTargetSockets(Context, Snapshot, TargetIndex, OutTargetsData);
+	}
+}
 
-	OutTargetsData.Empty();
-	OutTargetsData.Reserve(RegisteredTargets.Num());
+void UWeightedTargetHandler::GatherPrimaryCandidates(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, TArray<int32>& OutTargetIndices) const
+{
+	OutTargetIndices.Reset();
 
-	for (UTargetComponent* const Target : RegisteredTargets)
+	if (bDistanceCheck)
 	{
-		if (ShouldSkipTargetPrimaryPass(Context, Target))
+		//Only Targets within the largest capture radius and the view cone are sampled.
+		UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+		const float QueryRadius = CaptureRadiusScale * FMath::Max(DefaultCaptureRadius, TargetManager.GetMaxCustomCaptureRadius());
+		TArray<UTargetComponent*> Candidates;
+
 		{
-			continue;
+			LOT_SCOPED_EVENT(WTH_QueryTargets);
+			TargetManager.QueryTargets(Context.ViewLocation, QueryRadius, Context.ViewRotationMatrix.GetScaledAxis(EAxis::X), ViewConeAngle, Candidates, TargetableChannels);
 		}
 
-		for (const FName TargetSocket : Target->GetSockets())
+		OutTargetIndices.Reserve(Candidates.Num());
+
+		for (const UTargetComponent* const Target : Candidates)
 		{
-			const FTargetInfo CurrentTarget = { Target, TargetSocket };
+			const int32 TargetIndex = Snapshot.FindTargetIndex(Target);
 
-			//Skip already captured Target and Socket.
-			if (Context.CapturedTarget.Target == CurrentTarget)
+			if (TargetIndex != INDEX_NONE)
 			{
-				continue;
+				OutTargetIndices.Add(TargetIndex);
 			}
+		}
+	}
+	else
+	{
+		//Only the partitions of the targetable channels are sampled.
+		Snapshot.GatherTargetIndices(TargetableChannels, OutTargetIndices);
+	}
+}
+
+void UWeightedTargetHandler::SampleTargetPrimaryPass(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData)
+{
+	if (!ShouldSkipTargetPrimaryPass(Context, Snapshot, TargetIndex))
+	{
+		ExpandTargetSockets(Context, Snapshot, TargetIndex, OutTargetsData);
+	}
+}
+
+void UWeightedTargetHandler::ExpandTargetSockets(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData) const
+{
+	UTargetComponent* const Target = Snapshot.GetTarget(TargetIndex);
+	const TArrayView<const FName> Sockets = Snapshot.GetSockets(TargetIndex);
+	const TArrayView<const FVector> SocketLocations = Snapshot.GetSocketLocations(TargetIndex);
+
+	for (int32 SocketIndex = 0; SocketIndex < Sockets.Num(); ++SocketIndex)
+	{
+		const FTargetInfo CurrentTarget = { Target, Sockets[SocketIndex] };
+
+		//Skip already captured Target and Socket.
+		if (Context.CapturedTarget.Target == CurrentTarget)
+		{
+			continue;
+		}
+
+		FTargetContext TargetContext = CreateTargetContext(Context, CurrentTarget, SocketLocations[SocketIndex]);
+
+		if (IsTargetContextInRange(Context, TargetContext))
+		{
+			OutTargetsData.Add(TargetContext);
+		}
+	}
+}
+
+void UWeightedTargetHandler::SelectTargetsToExpand(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, TArray<int32>& InOutTargetIndices) const
+{
+	LOT_SCOPED_EVENT(WTH_SelectTargetsToExpand);
+
+	const FVector ViewDirection = Context.ViewRotationMatrix.GetScaledAxis(EAxis::X);
+	const float ViewConeAngleRad = FMath::DegreesToRadians(ViewConeAngle);
 
-			FTargetContext TargetContext = CreateTargetContext(Context, CurrentTarget);
+	TArray<FTargetContext> TargetsData;
+	TArray<float> Priorities;
+	TArray<int32> TargetIndices;
+	TargetsData.Reserve(InOutTargetIndices.Num());
+	Priorities.Reserve(InOutTargetIndices.Num());
+	TargetIndices.Reserve(InOutTargetIndices.Num());
+
+	for (const int32 TargetIndex : InOutTargetIndices)
+	{
+		const FSphere& Bounds = Snapshot.GetBounds(TargetIndex);
+		FTargetContext TargetContext = CreateTargetContext(Context, { Snapshot.GetTarget(TargetIndex) }, Bounds.Center);
+		const float Distance = FMath::Sqrt(TargetContext.DistanceSq);
 
-			//Check if in view cone.
-			const float DeltaConeAngle = FMath::RadiansToDegrees(FMath::Acos(Context.ViewRotationMatrix.GetScaledAxis(EAxis::X) | TargetContext.Direction));
+		//Conservative cone test. The Sockets might be inside the cone even if the bounds center isn't.
+		if (Distance > Bounds.W)
+		{
+			const float Angle = FMath::Acos(FMath::Clamp(ViewDirection | TargetContext.Direction, -1.f, 1.f));
 
-			if (DeltaConeAngle > ViewConeAngle)
+			if (Angle - FMath::Asin(Bounds.W / Distance) > ViewConeAngleRad)
 			{
 				continue;
 			}
+		}
 
-			//Check if in input range.
-			if (Context.Mode == EFindTargetContextMode::Switch)
-			{
-				CalcDeltaAngle2D(Context, TargetContext);
+		if (Context.Mode == EFindTargetContextMode::Switch)
+		{
+			CalcDeltaAngle2D(Context, TargetContext);
+		}
 
-				if (TargetContext.DeltaAngle2D > PlayerInputAngularRange)
-				{
-					continue;
-				}
-			}
+		TargetsData.Add(TargetContext);
+		Priorities.Add(Snapshot.GetPriority(TargetIndex));
+		TargetIndices.Add(TargetIndex);
+	}
 
-			OutTargetsData.Add(TargetContext);
+	SolveTargetWeights(Context, MakeSolverParams(Context), Priorities, TargetsData);
+
+	//Partially order Targets by weight.
+	TArray<int32> Order;
+	Order.Reserve(TargetsData.Num());
+
+	for (int32 i = 0; i < TargetsData.Num(); ++i)
+	{
+		Order.Add(i);
+	}
+
+	auto WeightPredicate = [&TargetsData](int32 lhs, int32 rhs)
+		{
+			return TargetsData[lhs].Weight < TargetsData[rhs].Weight;
+		};
+
+	Order.Heapify(WeightPredicate);
+	InOutTargetIndices.Reset();
+
+	while (Order.Num() > 0 && InOutTargetIndices.Num() < MaxExpandedTargets)
+	{
+		int32 Index;
+		Order.HeapPop(Index, WeightPredicate, false);
+		InOutTargetIndices.Add(TargetIndices[Index]);
+	}
+}
+
+bool UWeightedTargetHandler::IsTargetContextInRange(const FFindTargetContext& Context, FTargetContext& TargetContext)
+{
+	//Check if in view cone. Cosines are compared instead of angles.
+	if ((Context.ViewRotationMatrix.GetScaledAxis(EAxis::X) | TargetContext.Direction) < Context.CosViewConeAngle)
+	{
+		return false;
+	}
+
+	//Check if in input range.
+	if (Context.Mode == EFindTargetContextMode::Switch)
+	{
+		const float CosDeltaAngle2D = CalcDeltaDirection2D(Context, TargetContext);
+
+		if (CosDeltaAngle2D < Context.CosPlayerInputAngularRange)
+		{
+			return false;
 		}
+
+		TargetContext.DeltaAngle2D = FMath::RadiansToDegrees(FMath::Acos(CosDeltaAngle2D));
 	}
+
+	return true;
 }
 
-bool UWeightedTargetHandler::ShouldSkipTargetPrimaryPass(const FFindTargetContext& Context, const UTargetComponent* Target) const
+bool UWeightedTargetHandler::ShouldSkipTargetPrimaryPass(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex) const
 {
-	if (!IsTargetValid(Target))
+	if (!IsTargetValid(Snapshot.GetTarget(TargetIndex)))
 	{
 		return true;
 	}
 
-	const AActor* const TargetActor = Target->GetOwner();
-
-	if (bRecentRenderCheck && !TargetActor->WasRecentlyRendered(RecentTolerance))
+	if (bRecentRenderCheck && (GetWorld()->GetTimeSeconds() - Snapshot.GetLastRenderTime(TargetIndex)) > RecentTolerance)
 	{
 		return true;
 	}
@@ -213,8 +594,8 @@ bool UWeightedTargetHandler::ShouldSkipTargetPrimaryPass(const FFindTargetContex
 	if (bDistanceCheck)
 	{
 		//It'd be more correct to check the distance per socket, but this is faster.
-		const float DistanceSq = (Context.ViewLocation - TargetActor->GetActorLocation()).SizeSquared();
-		const float TargetCaptureRadius = GetTargetCaptureRadius(Target);
+		const float DistanceSq = (Context.ViewLocation - Snapshot.GetActorLocation(TargetIndex)).SizeSquared();
+		const float TargetCaptureRadius = CaptureRadiusScale * Snapshot.GetCaptureRadius(TargetIndex, DefaultCaptureRadius);
 
 		if (DistanceSq > FMath::Square(TargetCaptureRadius) || DistanceSq < FMath::Square(NearClipRadius))
 		{
@@ -227,10 +608,94 @@ bool UWeightedTargetHandler::ShouldSkipTargetPrimaryPass(const FFindTargetContex
 
 void UWeightedTargetHandler::PerformSolverPass(FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData)
 {
-	for (FTargetContext& TargetContext : InOutTargetsData)
+	if (!CanUseBatchSolver())
+	{
+		for (FTargetContext& TargetContext : InOutTargetsData)
+		{
+			TargetContext.Weight = LOT_NATIVE_EVENT(bIsCalculateTargetWeightOverridden, CalculateTargetWeight, Context, TargetContext);
+		}
+
+		return;
+	}
+
+	TArray<float, TInlineAllocator<64>> Priorities;
+	Priorities.Reserve(InOutTargetsData.Num());
+
+	for (const FTargetContext& TargetContext : InOutTargetsData)
+	{
+		Priorities.Add(TargetContext.Target->Priority);
+	}
+
+	SolveTargetWeights(Context, MakeSolverParams(Context), Priorities, InOutTargetsData);
+}
+
+void UWeightedTargetHandler::SolveTargetWeights(const FFindTargetContext& Context, const FWeightedTargetSolverParams& Params, TArrayView<const float> Priorities, TArray<FTargetContext>& InOutTargetsData)
+{
+	check(Priorities.Num() == InOutTargetsData.Num());
+
+	FMemMark MemMark(FMemStack::Get());
+	FWeightedTargetSolverData SolverData;
+	SolverData.Init(InOutTargetsData.Num());
+
+	for (int32 i = 0; i < InOutTargetsData.Num(); ++i)
+	{
+		const FTargetContext& TargetContext = InOutTargetsData[i];
+		SolverData.DistanceSq[i] = TargetContext.DistanceSq;
+		SolverData.CosDeltaAngle[i] = TargetContext.Direction | Context.SolverViewDirection;
+		SolverData.DeltaAngle2D[i] = TargetContext.DeltaAngle2D;
+		SolverData.Priority[i] = Priorities[i];
+	}
+
+	WeightedTargetSolver::Solve(Params, SolverData);
+
+	for (int32 i = 0; i < InOutTargetsData.Num(); ++i)
+	{
+		InOutTargetsData[i].Weight = SolverData.Weight[i];
+	}
+}
+
+bool UWeightedTargetHandler::CanUseBatchSolver() const
+{
+	return !bIsCalculateTargetWeightOverridden;
+}
+
+FWeightedTargetSolverParams UWeightedTargetHandler::MakeSolverParams(const FFindTargetContext& Context) const
+{
+	FWeightedTargetSolverParams Params;
+	const float WeightSum = DistanceWeight + DeltaAngleWeight + PlayerInputWeight + TargetPriorityWeight;
+
+	if (FMath::IsNearlyZero(WeightSum))
+	{
+		return Params;
+	}
+
+	const float Scale = PureDefaultWeight / WeightSum;
+
+	auto AddTerm = [&Params, Scale](float Weight, EWeightedTargetSolverTerm::Type Term, float& OutScale)
+		{
+			if (Weight > UE_KINDA_SMALL_NUMBER)
+			{
+				OutScale = Weight * Scale;
+				Params.TermMask |= Term;
+			}
+		};
+
+	//The kernel is specialized for the enabled terms, so disabled ones cost nothing per Target.
+	AddTerm(DistanceWeight, EWeightedTargetSolverTerm::Distance, Params.DistanceScale);
+	AddTerm(DeltaAngleWeight, EWeightedTargetSolverTerm::DeltaAngle, Params.DeltaAngleScale);
+	AddTerm(TargetPriorityWeight, EWeightedTargetSolverTerm::Priority, Params.PriorityScale);
+
+	if (Context.Mode == EFindTargetContextMode::Switch)
 	{
-		TargetContext.Weight = CalculateTargetWeight(Context, TargetContext);
+		AddTerm(PlayerInputWeight, EWeightedTargetSolverTerm::PlayerInput, Params.PlayerInputScale);
 	}
+
+	Params.InvDistanceMaxFactorSq = 1.f / FMath::Square(DistanceMaxFactor);
+	Params.InvDeltaAngleMaxFactorRad = FMath::RadiansToDegrees(1.f) / DeltaAngleMaxFactor;
+	Params.InvPlayerInputAngularRange = PlayerInputAngularRange > 0.f ? 1.f / PlayerInputAngularRange : 0.f;
+	Params.MinimumFactorThreshold = MinimumFactorThreshold;
+
+	return Params;
 }
 
 float UWeightedTargetHandler::CalculateTargetWeight_Implementation(const FFindTargetContext& Context, const FTargetContext& TargetContext) const
@@ -292,37 +757,55 @@ FFindTargetRequestResponse UWeightedTargetHandler::PerformSecondarySamplingPass(
 			OutResponse.Target = InTargetsData[0].Target;
 		}
 
-		OutResponse.Payload = GenerateDetailedResponse(Context, InTargetsData);
+		//The caller-owned buffer is swapped with the scratch one, so both keep their capacity.
+		if (FWeightedDetailedResponseData* const Buffer = Exchange(DetailedResponseBuffer, nullptr))
+		{
+			Buffer->Context = Context;
+			Swap(Buffer->TargetsData, InTargetsData);
+		}
+		else
+		{
+			OutResponse.Payload = GenerateDetailedResponse(Context, InTargetsData);
+		}
 	}
 	else
 	{
-		const auto* const FoundTargetContext = InTargetsData.FindByPredicate([this, &Context](const FTargetContext& TargetContext)
+		auto WeightPredicate = [](const FTargetContext& lhs, const FTargetContext& rhs)
 			{
-				return !ShouldSkipTargetSecondaryPass(Context, TargetContext);
-			});
+				return lhs.Weight < rhs.Weight;
+			};
+
+		//Only the best candidates are expanded until one passes the checks.
+		FTargetContext TargetContext;
 
-		if (FoundTargetContext)
+		while (InTargetsData.Num() > 0)
 		{
-			OutResponse.Target = FoundTargetContext->Target;
+			InTargetsData.HeapPop(TargetContext, WeightPredicate, false);
+
+			if (!ShouldSkipTargetSecondaryPass(Context, TargetContext))
+			{
+				OutResponse.Target = TargetContext.Target;
+				break;
+			}
 		}
 	}
 
 	return OutResponse;
 }
 
-bool UWeightedTargetHandler::ShouldSkipTargetSecondaryPass(const FFindTargetContext& Context, const FTargetContext& TargetContext) const
+bool UWeightedTargetHandler::ShouldSkipTargetSecondaryPass(const FFindTargetContext& Context, const FTargetContext& TargetContext, bool bCheckLineOfSight) const
 {
-	if (ShouldSkipTargetCustom(Context, TargetContext))
+	if (LOT_NATIVE_EVENT(bIsShouldSkipTargetCustomOverridden, ShouldSkipTargetCustom, Context, TargetContext))
 	{
 		return true;
 	}
 
-	if (bScreenCapture && !IsTargetOnScreen(Context, TargetContext))
+	if (bScreenCapture && !Context.bScreenCullingPerformed && !IsTargetOnScreen(Context, TargetContext))
 	{
 		return true;
 	}
 
-	if (bLineOfSightCheck && !LineOfSightTrace(Context.ViewLocation, TargetContext.Location, TargetContext.Target->GetOwner()))
+	if (bCheckLineOfSight && bLineOfSightCheck && !CachedLineOfSightTrace(Context.ViewLocation, TargetContext.Target, TargetContext.Location))
 	{
 		return true;
 	}
@@ -330,22 +813,1092 @@ bool UWeightedTargetHandler::ShouldSkipTargetSecondaryPass(const FFindTargetCont
 	return false;
 }
 
-UWeightedTargetHandlerDetailedResponse* UWeightedTargetHandler::GenerateDetailedResponse(const FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData)
+/*******************************************************************************************/
+/******************************** Target Switching *****************************************/
+/*******************************************************************************************/
+
+void UWeightedTargetHandler::UpdateSwitchSectors(const FRotator& ViewRotation)
 {
-	auto* const Response = NewObject<UWeightedTargetHandlerDetailedResponse>(this, FName(TEXT("WeightedTargetHandler_DetailedResponse")), RF_StrongRefOnFrame | RF_Transient);
+	const float Time = GetWorld()->GetTimeSeconds();
+	const FVector ViewDirection = ViewRotation.Vector();
 
-	if (Response)
+	//Between the updates nothing is evaluated, not even the context, unless the view has noticeably rotated.
+	if (!bBuildingSwitchSectors 
+		&& (Time - PendingSwitchSectorsTime) < SwitchSectorsUpdateInterval 
+		&& (ViewDirection | PendingSwitchSectorsViewDirection) >= FMath::Cos(FMath::DegreesToRadians(SwitchSectorsViewAngleTolerance)))
 	{
-		Response->Context = Context;
-		Response->TargetsData = MoveTemp(InTargetsData);
+		return;
 	}
 
-	return Response;
-}
+	LOT_SCOPED_EVENT(WTH_UpdateSwitchSectors);
 
-/*******************************************************************************************/
-/*********************************** Helpers ***********************************************/
-/*******************************************************************************************/
+	UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	FTargetSnapshot& Snapshot = TargetManager.GetTargetSnapshot();
+	FFindTargetContext Context = CreateFindTargetContext(EFindTargetContextMode::Switch, FFindTargetRequestParams());
+
+	//A new cycle starts once the interval has elapsed since the previous one has started.
+	if (!bBuildingSwitchSectors)
+	{
+		TArray<int32> TargetIndices;
+		GatherPrimaryCandidates(Context, Snapshot, TargetIndices);
+
+		PendingSwitchTargets.Reset(TargetIndices.Num());
+
+		for (const int32 TargetIndex : TargetIndices)
+		{
+			PendingSwitchTargets.Add(Snapshot.GetTarget(TargetIndex)->GetTargetHandle());
+		}
+
+		PendingSwitchSectors.Init(FSwitchSector(), SwitchSectorsNum);
+		PendingSwitchSectorsTime = Time;
+		PendingSwitchSectorsViewDirection = ViewDirection;
+		bBuildingSwitchSectors = true;
+	}
+
+	for (int32 NumEvaluated = 0; NumEvaluated < SwitchTargetsPerFrame && PendingSwitchTargets.Num() > 0; ++NumEvaluated)
+	{
+		//Handles of unregistered Targets are dangling.
+		const UTargetComponent* const Target = TargetManager.GetTarget(PendingSwitchTargets.Pop(false));
+		const int32 TargetIndex = Target ? Snapshot.FindTargetIndex(Target) : INDEX_NONE;
+
+		if (TargetIndex == INDEX_NONE || ShouldSkipTargetPrimaryPass(Context, Snapshot, TargetIndex))
+		{
+			continue;
+		}
+
+		const TArrayView<const FName> Sockets = Snapshot.GetSockets(TargetIndex);
+		const TArrayView<const FVector> SocketLocations = Snapshot.GetSocketLocations(TargetIndex);
+
+		for (int32 SocketIndex = 0; SocketIndex < Sockets.Num(); ++SocketIndex)
+		{
+			const FTargetInfo CurrentTarget = { Snapshot.GetTarget(TargetIndex), Sockets[SocketIndex] };
+
+			if (Context.CapturedTarget.Target == CurrentTarget)
+			{
+				continue;
+			}
+
+			FTargetContext TargetContext = CreateTargetContext(Context, CurrentTarget, SocketLocations[SocketIndex]);
+
+			if ((Context.ViewRotationMatrix.GetScaledAxis(EAxis::X) | TargetContext.Direction) < Context.CosViewConeAngle)
+			{
+				continue;
+			}
+
+			CalcDeltaDirection2D(Context, TargetContext);
+
+			//The Target competes in every sector whose direction is within the input range.
+			for (int32 SectorIndex = 0; SectorIndex < PendingSwitchSectors.Num(); ++SectorIndex)
+			{
+				const FVector2D SectorDirection = GetSwitchSectorDirection(SectorIndex);
+				const float CosDeltaAngle2D = FMath::Clamp(TargetContext.DeltaDirection2D | SectorDirection, -1.f, 1.f);
+
+				if (CosDeltaAngle2D < Context.CosPlayerInputAngularRange)
+				{
+					continue;
+				}
+
+				Context.PlayerInputDirection = SectorDirection;
+				TargetContext.DeltaAngle2D = FMath::RadiansToDegrees(FMath::Acos(CosDeltaAngle2D));
+				const float Weight = LOT_NATIVE_EVENT(bIsCalculateTargetWeightOverridden, CalculateTargetWeight, Context, TargetContext);
+
+				if (Weight < PendingSwitchSectors[SectorIndex].Weight)
+				{
+					PendingSwitchSectors[SectorIndex] = { CurrentTarget->GetTargetHandle(), CurrentTarget.Socket, Weight };
+				}
+			}
+		}
+	}
+
+	if (PendingSwitchTargets.IsEmpty())
+	{
+		Swap(SwitchSectors, PendingSwitchSectors);
+		SwitchSectorsUpdateTime = PendingSwitchSectorsTime;
+		bBuildingSwitchSectors = false;
+	}
+}
+
+FTargetInfo UWeightedTargetHandler::FindPrecomputedSwitchTarget(const FFindTargetContext& Context)
+{
+	if (!bPrecomputeSwitchTargets 
+		|| SwitchSectors.IsEmpty() 
+		|| Context.RequestParams.bGenerateDetailedResponse 
+		|| Context.PlayerInputDirection.IsNearlyZero() 
+		|| (GetWorld()->GetTimeSeconds() - SwitchSectorsUpdateTime) > SwitchSectorsMaxAge)
+	{
+		return FTargetInfo::NULL_TARGET;
+	}
+
+	LOT_SCOPED_EVENT(WTH_FindPrecomputedSwitchTarget);
+
+	const FSwitchSector& SwitchSector = SwitchSectors[GetSwitchSectorIndex(Context.PlayerInputDirection)];
+
+	//The Target might have been unregistered since the update. Handles of unregistered Targets are dangling.
+	const FTargetInfo SwitchTarget = { UTargetManager::Get(*GetWorld()).GetTarget(SwitchSector.TargetHandle), SwitchSector.Socket };
+
+	if (!SwitchTarget.TargetComponent 
+		|| !IsTargetValid(SwitchTarget.TargetComponent) 
+		|| !SwitchTarget->IsSocketValid(SwitchTarget.Socket) 
+		|| Context.CapturedTarget.Target == SwitchTarget)
+	{
+		return FTargetInfo::NULL_TARGET;
+	}
+
+	FTargetContext TargetContext = CreateTargetContext(Context, SwitchTarget);
+
+	if (bDistanceCheck && TargetContext.DistanceSq > FMath::Square(GetTargetCaptureRadius(SwitchTarget.TargetComponent)))
+	{
+		return FTargetInfo::NULL_TARGET;
+	}
+
+	if (!IsTargetContextInRange(Context, TargetContext) || ShouldSkipTargetSecondaryPass(Context, TargetContext))
+	{
+		return FTargetInfo::NULL_TARGET;
+	}
+
+	return SwitchTarget;
+}
+
+void UWeightedTargetHandler::ResetSwitchSectors()
+{
+	SwitchSectors.Reset();
+	PendingSwitchSectors.Reset();
+	PendingSwitchTargets.Reset();
+	PendingSwitchSectorsTime = -FLT_MAX;
+	bBuildingSwitchSectors = false;
+}
+
+int32 UWeightedTargetHandler::GetSwitchSectorIndex(const FVector2D& Direction) const
+{
+	const float SectorAngle = UE_TWO_PI / SwitchSectorsNum;
+	const int32 SectorIndex = FMath::RoundToInt32(FMath::Atan2(Direction.Y, Direction.X) / SectorAngle);
+	return (SectorIndex % SwitchSectorsNum + SwitchSectorsNum) % SwitchSectorsNum;
+}
+
+FVector2D UWeightedTargetHandler::GetSwitchSectorDirection(int32 SectorIndex) const
+{
+	float Sin, Cos;
+	FMath::SinCos(&Sin, &Cos, SectorIndex * UE_TWO_PI / SwitchSectorsNum);
+	return FVector2D(Cos, Sin);
+}
+
+/*******************************************************************************************/
+/********************************* Screen Culling ******************************************/
+/*******************************************************************************************/
+
+void UWeightedTargetHandler::PerformScreenCullingPass(FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData) const
+{
+	if (!Context.bHasScreenData)
+	{
+		return;
+	}
+
+	TArray<FVector> Locations;
+	Locations.Reserve(InOutTargetsData.Num());
+
+	for (const FTargetContext& TargetContext : InOutTargetsData)
+	{
+		Locations.Add(TargetContext.Location);
+	}
+
+	TBitArray<> OnScreen;
+	CalcOnScreen(Context, Locations, OnScreen);
+
+	int32 NumOnScreen = 0;
+
+	for (int32 i = 0; i < InOutTargetsData.Num(); ++i)
+	{
+		if (OnScreen[i])
+		{
+			if (NumOnScreen != i)
+			{
+				InOutTargetsData[NumOnScreen] = MoveTemp(InOutTargetsData[i]);
+			}
+
+			++NumOnScreen;
+		}
+	}
+
+	InOutTargetsData.SetNum(NumOnScreen, false);
+	Context.bScreenCullingPerformed = true;
+}
+
+void UWeightedTargetHandler::CalcOnScreen(const FFindTargetContext& Context, TArrayView<const FVector> Locations, TBitArray<>& OutOnScreen)
+{
+	constexpr int32 VectorWidth = 4;
+	const int32 NumLocations = Locations.Num();
+	const int32 NumPadded = Align(NumLocations, VectorWidth);
+
+	//Structure of arrays relative to the view.
+	FMemMark MemMark(FMemStack::Get());
+	TArray<float, TMemStackAllocator<>> X, Y, Z;
+	X.SetNumZeroed(NumPadded);
+	Y.SetNumZeroed(NumPadded);
+	Z.SetNumZeroed(NumPadded);
+
+	for (int32 i = 0; i < NumLocations; ++i)
+	{
+		const FVector RelativeLocation = Locations[i] - Context.ViewLocation;
+		X[i] = RelativeLocation.X;
+		Y[i] = RelativeLocation.Y;
+		Z[i] = RelativeLocation.Z;
+	}
+
+	const FMatrix44f& M = Context.ScreenMatrix;
+
+	auto MakeColumn = [&M](int32 Column)
+		{
+			return MakeVectorRegisterFloat(M.M[0][Column], M.M[1][Column], M.M[2][Column], M.M[3][Column]);
+		};
+
+	auto TransformByColumn = [](const VectorRegister4Float& Column, const VectorRegister4Float& VX, const VectorRegister4Float& VY, const VectorRegister4Float& VZ)
+		{
+			VectorRegister4Float Result = VectorReplicate(Column, 3);
+			Result = VectorMultiplyAdd(VX, VectorReplicate(Column, 0), Result);
+			Result = VectorMultiplyAdd(VY, VectorReplicate(Column, 1), Result);
+			return VectorMultiplyAdd(VZ, VectorReplicate(Column, 2), Result);
+		};
+
+	//Clip = Location * M. Only X, Y and W are needed.
+	const VectorRegister4Float ColumnX = MakeColumn(0);
+	const VectorRegister4Float ColumnY = MakeColumn(1);
+	const VectorRegister4Float ColumnW = MakeColumn(3);
+	const VectorRegister4Float LimitX = VectorSetFloat1(Context.ScreenLimits.X);
+	const VectorRegister4Float LimitY = VectorSetFloat1(Context.ScreenLimits.Y);
+
+	OutOnScreen.Init(false, NumLocations);
+
+	for (int32 i = 0; i < NumPadded; i += VectorWidth)
+	{
+		const VectorRegister4Float VX = VectorLoad(&X[i]);
+		const VectorRegister4Float VY = VectorLoad(&Y[i]);
+		const VectorRegister4Float VZ = VectorLoad(&Z[i]);
+
+		const VectorRegister4Float ClipX = TransformByColumn(ColumnX, VX, VY, VZ);
+		const VectorRegister4Float ClipY = TransformByColumn(ColumnY, VX, VY, VZ);
+		const VectorRegister4Float ClipW = TransformByColumn(ColumnW, VX, VY, VZ);
+
+		const VectorRegister4Float InsideX = VectorCompareLT(VectorAbs(ClipX), VectorMultiply(ClipW, LimitX));
+		const VectorRegister4Float InsideY = VectorCompareLT(VectorAbs(ClipY), VectorMultiply(ClipW, LimitY));
+
+		//Locations behind the view aren't rejected. See IsTargetOnScreen().
+		const VectorRegister4Float BehindView = VectorCompareLE(ClipW, VectorZeroFloat());
+		const uint32 Mask = VectorMaskBits(VectorBitwiseOr(VectorBitwiseAnd(InsideX, InsideY), BehindView));
+
+		for (int32 Lane = 0; Lane < VectorWidth && i + Lane < NumLocations; ++Lane)
+		{
+			OutOnScreen[i + Lane] = (Mask & (1 << Lane)) != 0;
+		}
+	}
+}
+
+/*******************************************************************************************/
+/********************************** Async Finding ******************************************/
+/*******************************************************************************************/
+
+/**
+ * Data of the FindTargetAsync() request captured on the game thread.
+ * The worker only reads the plain view data and the Sockets inputs and writes the candidates. No UObject is referenced by them.
+ */
+struct FWeightedFindTargetTask
+{
+	//Full context for the game thread passes. Isn't touched by the worker.
+	FFindTargetContext Context;
+
+	//Copy of the context without UObjects for the worker.
+	FFindTargetContext ViewContext;
+	FWeightedTargetSolverParams SolverParams;
+
+	//The captured Target at the time of the request. The request is restarted if it changes.
+	FTargetHandle CapturedTargetHandle;
+	FName CapturedSocket = NAME_None;
+
+	//Sockets of all candidates flattened.
+	TArray<FTargetHandle> SocketHandles;
+	TArray<FName> SocketNames;
+	TArray<FVector> SocketLocations;
+	TArray<float> SocketPriorities;
+
+	//The output with calculated weights, but without the Targets. Targets might be destroyed while the task runs,
+	//so they're assigned on the game thread once resolved by the handles of the Sockets at the same indices.
+	TArray<FTargetContext> TargetsData;
+	TArray<int32> TargetSocketIndices;
+};
+
+bool UWeightedTargetHandler::CanFindTargetOffGameThread(const FFindTargetRequestParams& RequestParams) const
+{
+	//Blueprint overrides and the detailed response can only be handled on the game thread.
+	return bAsyncFindTarget && !IsFindTargetOverridden() && CanUseBatchSolver() && !RequestParams.bGenerateDetailedResponse;
+}
+
+void UWeightedTargetHandler::CaptureFindTargetTask(FWeightedFindTargetTask& Task)
+{
+	LOT_SCOPED_EVENT(WTH_CaptureFindTargetTask);
+
+	FTargetSnapshot& Snapshot = UTargetManager::Get(*GetWorld()).GetTargetSnapshot();
+	TArray<int32> TargetIndices;
+	GatherPrimaryCandidates(Task.Context, Snapshot, TargetIndices);
+
+	//Per Target checks touch UObjects, so they're performed here.
+	TargetIndices.RemoveAllSwap([&](int32 TargetIndex)
+		{
+			return ShouldSkipTargetPrimaryPass(Task.Context, Snapshot, TargetIndex);
+		}, false);
+
+	//Same as the synchronous primary pass.
+	if (MaxExpandedTargets > 0 && TargetIndices.Num() > MaxExpandedTargets)
+	{
+		SelectTargetsToExpand(Task.Context, Snapshot, TargetIndices);
+	}
+
+	Task.SolverParams = MakeSolverParams(Task.Context);
+
+	if (Task.Context.CapturedTarget.Target != FTargetInfo::NULL_TARGET)
+	{
+		Task.CapturedTargetHandle = Task.Context.CapturedTarget.Target->GetTargetHandle();
+		Task.CapturedSocket = Task.Context.CapturedTarget.Target.Socket;
+	}
+
+	Task.ViewContext = Task.Context;
+	Task.ViewContext.TargetHandler = nullptr;
+	Task.ViewContext.Instigator = nullptr;
+	Task.ViewContext.InstigatorPawn = nullptr;
+	Task.ViewContext.PlayerController = nullptr;
+	Task.ViewContext.CapturedTarget.Target = FTargetInfo::NULL_TARGET;
+
+	for (const int32 TargetIndex : TargetIndices)
+	{
+		UTargetComponent* const Target = Snapshot.GetTarget(TargetIndex);
+		const TArrayView<const FName> Sockets = Snapshot.GetSockets(TargetIndex);
+		const TArrayView<const FVector> SocketLocations = Snapshot.GetSocketLocations(TargetIndex);
+		const float Priority = Snapshot.GetPriority(TargetIndex);
+
+		for (int32 SocketIndex = 0; SocketIndex < Sockets.Num(); ++SocketIndex)
+		{
+			//Skip already captured Target and Socket.
+			if (Task.Context.CapturedTarget.Target != FTargetInfo(Target, Sockets[SocketIndex]))
+			{
+				Task.SocketHandles.Add(Target->GetTargetHandle());
+				Task.SocketNames.Add(Sockets[SocketIndex]);
+				Task.SocketLocations.Add(SocketLocations[SocketIndex]);
+				Task.SocketPriorities.Add(Priority);
+			}
+		}
+	}
+}
+
+void UWeightedTargetHandler::PerformFindTargetTask(FWeightedFindTargetTask& Task)
+{
+	LOT_SCOPED_EVENT(WTH_FindTargetTask);
+
+	FFindTargetContext& Context = Task.ViewContext;
+	TArray<float> Priorities;
+	Priorities.Reserve(Task.SocketLocations.Num());
+	Task.TargetsData.Reserve(Task.SocketLocations.Num());
+	Task.TargetSocketIndices.Reserve(Task.SocketLocations.Num());
+
+	TBitArray<> OnScreen;
+
+	if (Context.bHasScreenData)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_ScreenCulling);
+		CalcOnScreen(Context, Task.SocketLocations, OnScreen);
+		Context.bScreenCullingPerformed = true;
+	}
+
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_PrimarySampling);
+
+		for (int32 i = 0; i < Task.SocketLocations.Num(); ++i)
+		{
+			if (Context.bScreenCullingPerformed && !OnScreen[i])
+			{
+				continue;
+			}
+
+			//The Target is assigned on the game thread.
+			FTargetContext TargetContext;
+			TargetContext.Location = Task.SocketLocations[i];
+			const FVector Delta = TargetContext.Location - Context.ViewLocation;
+			TargetContext.DistanceSq = Delta.SizeSquared();
+
+			if (TargetContext.DistanceSq > UE_KINDA_SMALL_NUMBER)
+			{
+				TargetContext.Direction = Delta * FMath::InvSqrt(TargetContext.DistanceSq);
+			}
+
+			if (IsTargetContextInRange(Context, TargetContext))
+			{
+				Task.TargetsData.Add(TargetContext);
+				Task.TargetSocketIndices.Add(i);
+				Priorities.Add(Task.SocketPriorities[i]);
+			}
+		}
+	}
+
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_Solver);
+		SolveTargetWeights(Context, Task.SolverParams, Priorities, Task.TargetsData);
+	}
+
+	//The heap is built on the game thread once the Targets are resolved by the handles.
+}
+
+void UWeightedTargetHandler::CompletePendingFindTarget()
+{
+	if (!PendingFindTargetData.IsValid())
+	{
+		return;
+	}
+
+	LOT_SCOPED_EVENT(WTH_CompleteFindTargetTask);
+
+	//Usually has been done by now.
+	PendingFindTargetTask.Wait();
+
+	const TSharedPtr<FWeightedFindTargetTask> Task = MoveTemp(PendingFindTargetData);
+	FOnFindTargetRequestCompleted OnCompleted = MoveTemp(PendingFindTargetCallback);
+	PendingFindTargetData.Reset();
+	PendingFindTargetCallback.Unbind();
+	PendingFindTargetTask = UE::Tasks::FTask();
+
+	UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	const ULockOnTargetComponent* const Instigator = GetLockOnTargetComponent();
+
+	//The weights depend on the mode and the captured Target, so the request is restarted if they have changed since the capture.
+	const EFindTargetContextMode ContextMode = Instigator->IsTargetLocked() ? EFindTargetContextMode::Switch : EFindTargetContextMode::Find;
+	const bool bCapturedTargetChanged = ContextMode == EFindTargetContextMode::Switch
+		&& (TargetManager.GetTarget(Task->CapturedTargetHandle) != Instigator->GetTargetComponent() || Task->CapturedSocket != Instigator->GetCapturedSocket());
+
+	if (ContextMode != Task->Context.Mode || bCapturedTargetChanged)
+	{
+		FindTargetAsync(Task->Context.RequestParams, MoveTemp(OnCompleted));
+		return;
+	}
+
+	Task->Context.bScreenCullingPerformed = Task->ViewContext.bScreenCullingPerformed;
+	check(Task->TargetsData.Num() == Task->TargetSocketIndices.Num());
+
+	//Targets might have been destroyed since the capture, so they're resolved by the handles.
+	for (int32 i = Task->TargetsData.Num() - 1; i >= 0; --i)
+	{
+		const int32 SocketIndex = Task->TargetSocketIndices[i];
+		UTargetComponent* const Target = TargetManager.GetTarget(Task->SocketHandles[SocketIndex]);
+
+		if (Target && IsTargetValid(Target))
+		{
+			Task->TargetsData[i].Target = { Target, Task->SocketNames[SocketIndex] };
+		}
+		else
+		{
+			Task->TargetsData.RemoveAtSwap(i, 1, false);
+			Task->TargetSocketIndices.RemoveAtSwap(i, 1, false);
+		}
+	}
+
+	//Lightweight Targets are evaluated on the game thread, as in FindTargetBatched().
+	FTargetHandle LightweightTarget;
+	FilterByLightweightTarget(Task->Context, /*inout*/Task->TargetsData, LightweightTarget);
+
+	auto WeightPredicate = [](const FTargetContext& lhs, const FTargetContext& rhs)
+		{
+			return lhs.Weight < rhs.Weight;
+		};
+
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_Sort);
+		Task->TargetsData.Heapify(WeightPredicate);
+	}
+
+	if (CanTraceSpeculatively(Task->Context.RequestParams))
+	{
+		PerformSpeculativeSecondaryPass(Task->Context, /*in*/Task->TargetsData, LightweightTarget, MoveTemp(OnCompleted));
+		return;
+	}
+
+	FFindTargetRequestResponse Response;
+
+	if (Task->TargetsData.Num() > 0)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_SecondarySampling);
+		Response = PerformSecondarySamplingPass(Task->Context, /*in*/Task->TargetsData);
+	}
+
+	if (Response.Target == FTargetInfo::NULL_TARGET)
+	{
+		Response.LightweightTarget = LightweightTarget;
+	}
+
+	OnCompleted.ExecuteIfBound(Response);
+}
+
+void UWeightedTargetHandler::CancelPendingFindTarget()
+{
+	if (PendingFindTargetData.IsValid())
+	{
+		//The task references the handler.
+		PendingFindTargetTask.Wait();
+		PendingFindTargetData.Reset();
+		PendingFindTargetCallback.Unbind();
+		PendingFindTargetTask = UE::Tasks::FTask();
+	}
+
+	//Results of the in-flight traces are ignored.
+	PendingSpeculativeLineOfSight.Reset();
+}
+
+/**
+ * The best candidates of the FindTargetAsync() request traced at once.
+ * Targets might be destroyed before the traces are done, so they're resolved by the handles.
+ */
+struct FWeightedSpeculativeLineOfSight
+{
+	enum class EResult : uint8
+	{
+		Pending,
+		Visible,
+		Occluded
+	};
+
+	FFindTargetContext Context;
+
+	//Ordered by weight.
+	TArray<FTargetContext, TInlineAllocator<8>> Candidates;
+	TArray<FTargetHandle, TInlineAllocator<8>> CandidateHandles;
+	TArray<FLineOfSightQuery, TInlineAllocator<8>> Queries;
+	TArray<FTraceHandle, TInlineAllocator<8>> TraceHandles;
+	TArray<EResult, TInlineAllocator<8>> Results;
+
+	//The rest of the candidates heap with their handles in the same order. Traced one by one if none of the best ones is visible.
+	TArray<FTargetContext> TargetsData;
+	TArray<FTargetHandle> TargetHandles;
+
+	FTargetHandle LightweightTarget;
+	FOnFindTargetRequestCompleted OnCompleted;
+
+	//Whether the best visible candidate is known, i.e. all the better ones are occluded.
+	bool IsResolved() const
+	{
+		for (const EResult Result : Results)
+		{
+			if (Result != EResult::Occluded)
+			{
+				return Result == EResult::Visible;
+			}
+		}
+
+		return true;
+	}
+};
+
+bool UWeightedTargetHandler::CanTraceSpeculatively(const FFindTargetRequestParams& RequestParams) const
+{
+	//The detailed response needs all candidates checked.
+	return bLineOfSightCheck && SpeculativeLineOfSightCandidates > 1 && !IsFindTargetOverridden() && !RequestParams.bGenerateDetailedResponse;
+}
+
+void UWeightedTargetHandler::PerformSpeculativeSecondaryPass(FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData, const FTargetHandle& LightweightTarget, FOnFindTargetRequestCompleted&& OnCompleted)
+{
+	LOT_SCOPED_EVENT(WTH_SpeculativeLineOfSight);
+
+	auto WeightPredicate = [](const FTargetContext& lhs, const FTargetContext& rhs)
+		{
+			return lhs.Weight < rhs.Weight;
+		};
+
+	using EResult = FWeightedSpeculativeLineOfSight::EResult;
+	const TSharedRef<FWeightedSpeculativeLineOfSight> Pending = MakeShared<FWeightedSpeculativeLineOfSight>();
+	FTargetContext TargetContext;
+
+	//The best candidates that pass the other checks. The worse ones aren't needed once a visible one is cached.
+	while (InTargetsData.Num() > 0 && Pending->Candidates.Num() < SpeculativeLineOfSightCandidates && !(Pending->Results.Num() > 0 && Pending->Results.Last() == EResult::Visible))
+	{
+		InTargetsData.HeapPop(TargetContext, WeightPredicate, false);
+
+		if (ShouldSkipTargetSecondaryPass(Context, TargetContext, /*bCheckLineOfSight*/false))
+		{
+			continue;
+		}
+
+		const FLineOfSightQuery Query = MakeLineOfSightQuery(Context.ViewLocation, TargetContext.Target, TargetContext.Location);
+		bool bIsVisible = false;
+		const bool bIsCached = FindCachedLineOfSight(Query, bIsVisible);
+
+		Pending->Candidates.Add(TargetContext);
+		Pending->CandidateHandles.Add(TargetContext.Target->GetTargetHandle());
+		Pending->Queries.Add(Query);
+		Pending->TraceHandles.AddDefaulted();
+		Pending->Results.Add(!bIsCached ? EResult::Pending : bIsVisible ? EResult::Visible : EResult::Occluded);
+	}
+
+	Pending->Context = Context;
+	Pending->TargetsData = MoveTemp(InTargetsData);
+	Pending->TargetHandles.Reserve(Pending->TargetsData.Num());
+
+	for (const FTargetContext& RestTargetContext : Pending->TargetsData)
+	{
+		Pending->TargetHandles.Add(RestTargetContext.Target->GetTargetHandle());
+	}
+
+	Pending->LightweightTarget = LightweightTarget;
+	Pending->OnCompleted = MoveTemp(OnCompleted);
+	PendingSpeculativeLineOfSight = Pending;
+
+	if (Pending->IsResolved())
+	{
+		CompleteSpeculativeLineOfSight();
+		return;
+	}
+
+	if (!SpeculativeLineOfSightTraceDelegate.IsBound())
+	{
+		SpeculativeLineOfSightTraceDelegate.BindUObject(this, &UWeightedTargetHandler::OnSpeculativeLineOfSightTraceDone);
+	}
+
+	//All traces are issued at once and performed in parallel by the engine.
+	UWorld* const World = GetWorld();
+
+	for (int32 i = 0; i < Pending->Candidates.Num(); ++i)
+	{
+		if (Pending->Results[i] == EResult::Pending)
+		{
+			const FLineOfSightQuery& Query = Pending->Queries[i];
+			Pending->TraceHandles[i] = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Query.ViewLocation, Query.TargetLocation, TraceCollisionChannel,
+				MakeLineOfSightQueryParams(Pending->Candidates[i].Target->GetOwner()), FCollisionResponseParams::DefaultResponseParam, &SpeculativeLineOfSightTraceDelegate);
+		}
+	}
+}
+
+void UWeightedTargetHandler::OnSpeculativeLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	//Stale result of a superseded or already completed request.
+	if (!PendingSpeculativeLineOfSight.IsValid())
+	{
+		return;
+	}
+
+	FWeightedSpeculativeLineOfSight& Pending = *PendingSpeculativeLineOfSight;
+	const int32 Index = Pending.TraceHandles.IndexOfByKey(TraceHandle);
+
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FHitResult* const BlockingHit = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+	const bool bIsVisible = BlockingHit == nullptr;
+	Pending.Results[Index] = bIsVisible ? FWeightedSpeculativeLineOfSight::EResult::Visible : FWeightedSpeculativeLineOfSight::EResult::Occluded;
+	Pending.TraceHandles[Index] = FTraceHandle();
+
+	//The cache is keyed on the Target pointer, so the result of a destroyed Target isn't stored.
+	if (UTargetManager::Get(*GetWorld()).GetTarget(Pending.CandidateHandles[Index]))
+	{
+		CacheLineOfSight(Pending.Queries[Index], bIsVisible, BlockingHit ? BlockingHit->GetActor() : nullptr);
+	}
+
+	//The worse candidates aren't waited for once the best visible one is known.
+	if (Pending.IsResolved())
+	{
+		CompleteSpeculativeLineOfSight();
+	}
+}
+
+void UWeightedTargetHandler::CompleteSpeculativeLineOfSight()
+{
+	const TSharedPtr<FWeightedSpeculativeLineOfSight> Pending = MoveTemp(PendingSpeculativeLineOfSight);
+	PendingSpeculativeLineOfSight.Reset();
+
+	if (!Pending.IsValid())
+	{
+		return;
+	}
+
+	LOT_SCOPED_EVENT(WTH_CompleteSpeculativeLineOfSight);
+
+	const UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	FFindTargetRequestResponse Response;
+
+	for (int32 i = 0; i < Pending->Candidates.Num(); ++i)
+	{
+		if (Pending->Results[i] != FWeightedSpeculativeLineOfSight::EResult::Visible)
+		{
+			continue;
+		}
+
+		//The Target might have been destroyed or become invalid since the traces were issued.
+		UTargetComponent* const Target = TargetManager.GetTarget(Pending->CandidateHandles[i]);
+
+		if (Target && IsTargetValid(Target) && Target->IsSocketValid(Pending->Candidates[i].Target.Socket))
+		{
+			Response.Target = Pending->Candidates[i].Target;
+			break;
+		}
+	}
+
+	if (Response.Target == FTargetInfo::NULL_TARGET && Pending->TargetsData.Num() > 0)
+	{
+		check(Pending->TargetsData.Num() == Pending->TargetHandles.Num());
+
+		for (int32 i = Pending->TargetsData.Num() - 1; i >= 0; --i)
+		{
+			UTargetComponent* const Target = TargetManager.GetTarget(Pending->TargetHandles[i]);
+
+			if (!Target || !IsTargetValid(Target))
+			{
+				Pending->TargetsData.RemoveAtSwap(i, 1, false);
+				Pending->TargetHandles.RemoveAtSwap(i, 1, false);
+			}
+		}
+
+		Pending->TargetsData.Heapify([](const FTargetContext& lhs, const FTargetContext& rhs) { return lhs.Weight < rhs.Weight; });
+
+		LOT_SCOPED_EVENT(WTH_Pass_SecondarySampling);
+		Response = PerformSecondarySamplingPass(Pending->Context, /*in*/Pending->TargetsData);
+	}
+
+	if (Response.Target == FTargetInfo::NULL_TARGET)
+	{
+		Response.LightweightTarget = Pending->LightweightTarget;
+	}
+
+	Pending->OnCompleted.ExecuteIfBound(Response);
+}
+
+/*******************************************************************************************/
+/******************************* Incremental Finding ***************************************/
+/*******************************************************************************************/
+
+FFindTargetRequestResponse UWeightedTargetHandler::FindTargetIncrementalBatched(FFindTargetContext& Context)
+{
+	LOT_SCOPED_EVENT(WTH_IncrementalFinding);
+
+	UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	FTargetSnapshot& Snapshot = TargetManager.GetTargetSnapshot();
+	const float Time = GetWorld()->GetTimeSeconds();
+	const FVector ViewDirection = Context.ViewRotationMatrix.GetScaledAxis(EAxis::X);
+
+	//Every weight depends on the view, so the candidates are re-scored if it changes.
+	const bool bViewChanged = FVector::DistSquared(Context.ViewLocation, IncrementalViewLocation) > FMath::Square(IncrementalViewTolerance)
+		|| (ViewDirection | IncrementalViewDirection) < FMath::Cos(FMath::DegreesToRadians(IncrementalViewAngleTolerance));
+
+	//Only the changed set of Targets or their channels invalidate the candidates.
+	const bool bFullUpdate = (Time - IncrementalFullUpdateTime) > IncrementalFullUpdateInterval || TargetManager.GetTargetsVersion() != IncrementalTargetsVersion;
+
+	if (bFullUpdate)
+	{
+		//The previous Target is kept for the hysteresis.
+		IncrementalCandidates.Reset();
+		IncrementalTargetLocations.Reset();
+		IncrementalFullUpdateTime = Time;
+		IncrementalTargetsVersion = TargetManager.GetTargetsVersion();
+	}
+
+	if (bViewChanged || bFullUpdate)
+	{
+		IncrementalViewLocation = Context.ViewLocation;
+		IncrementalViewDirection = ViewDirection;
+	}
+
+	TArray<FTargetContext> NewCandidates;
+
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_IncrementalSampling);
+
+		//New Targets come from the spatial query. Only new and moved ones are re-sampled.
+		TArray<int32> TargetIndices;
+		GatherPrimaryCandidates(Context, Snapshot, TargetIndices);
+
+		TSet<const UTargetComponent*> ValidTargets;
+		TSet<const UTargetComponent*> DirtyTargets;
+		ValidTargets.Reserve(TargetIndices.Num());
+
+		for (const int32 TargetIndex : TargetIndices)
+		{
+			if (ShouldSkipTargetPrimaryPass(Context, Snapshot, TargetIndex))
+			{
+				continue;
+			}
+
+			const UTargetComponent* const Target = Snapshot.GetTarget(TargetIndex);
+			const FVector& ActorLocation = Snapshot.GetActorLocation(TargetIndex);
+			const FVector* const SampledLocation = IncrementalTargetLocations.Find(Target);
+			ValidTargets.Add(Target);
+
+			if (!SampledLocation || FVector::DistSquared(*SampledLocation, ActorLocation) > FMath::Square(IncrementalTargetTolerance))
+			{
+				DirtyTargets.Add(Target);
+				IncrementalTargetLocations.Add(Target, ActorLocation);
+				SampleIncrementalTarget(Context, Snapshot, TargetIndex, NewCandidates);
+			}
+		}
+
+		//Drop the candidates that have become invalid, left the query or are re-sampled.
+		IncrementalCandidates.RemoveAllSwap([&ValidTargets, &DirtyTargets](const FTargetContext& TargetContext)
+			{
+				return !ValidTargets.Contains(TargetContext.Target.TargetComponent) || DirtyTargets.Contains(TargetContext.Target.TargetComponent);
+			}, false);
+
+		for (auto It = IncrementalTargetLocations.CreateIterator(); It; ++It)
+		{
+			if (!ValidTargets.Contains(It->Key))
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	if (bViewChanged && !bFullUpdate && IncrementalCandidates.Num() > 0)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_IncrementalRescore);
+		RescoreIncrementalCandidates(Context);
+	}
+
+	if (NewCandidates.Num() > 0)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_Solver);
+		PerformSolverPass(Context, /*inout*/NewCandidates);
+		IncrementalCandidates.Append(NewCandidates);
+	}
+
+	//Sockets that have left the view cone stay cached, as they might return with the view.
+	TArray<FTargetContext> TargetsData;
+	TargetsData.Reserve(IncrementalCandidates.Num());
+
+	for (const FTargetContext& Candidate : IncrementalCandidates)
+	{
+		FTargetContext TargetContext = Candidate;
+
+		if (IsTargetContextInRange(Context, TargetContext))
+		{
+			TargetsData.Add(TargetContext);
+		}
+	}
+
+	//Lightweight Targets aren't cached, as the crowd moves constantly. Same as FindTarget(), they drop the worse regular candidates.
+	FTargetHandle LightweightTarget;
+	FilterByLightweightTarget(Context, /*inout*/TargetsData, LightweightTarget);
+
+	FFindTargetRequestResponse OutResponse;
+
+	if (TargetsData.Num() > 0)
+	{
+		LOT_SCOPED_EVENT(WTH_Pass_SecondarySampling);
+
+		const TArray<FTargetContext> InRangeCandidates = TargetsData;
+		TargetsData.Heapify([](const FTargetContext& lhs, const FTargetContext& rhs)
+			{
+				return lhs.Weight < rhs.Weight;
+			});
+
+		OutResponse = PerformSecondarySamplingPass(Context, /*in*/TargetsData);
+
+		//Keep the previous Target unless the new one is noticeably better.
+		if (OutResponse.Target != IncrementalTarget && IncrementalTarget != FTargetInfo::NULL_TARGET && IncrementalHysteresis > 0.f)
+		{
+			const FTargetContext* const Previous = InRangeCandidates.FindByPredicate([this](const FTargetContext& TargetContext) { return TargetContext.Target == IncrementalTarget; });
+			const FTargetContext* const Best = InRangeCandidates.FindByPredicate([&OutResponse](const FTargetContext& TargetContext) { return TargetContext.Target == OutResponse.Target; });
+
+			if (Previous && (!Best || Best->Weight > Previous->Weight * (1.f - IncrementalHysteresis)) && !ShouldSkipTargetSecondaryPass(Context, *Previous))
+			{
+				OutResponse.Target = IncrementalTarget;
+			}
+		}
+	}
+
+	if (OutResponse.Target == FTargetInfo::NULL_TARGET)
+	{
+		OutResponse.LightweightTarget = LightweightTarget;
+	}
+
+	IncrementalTarget = OutResponse.Target;
+	return OutResponse;
+}
+
+void UWeightedTargetHandler::SampleIncrementalTarget(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData) const
+{
+	UTargetComponent* const Target = Snapshot.GetTarget(TargetIndex);
+	const TArrayView<const FName> Sockets = Snapshot.GetSockets(TargetIndex);
+	const TArrayView<const FVector> SocketLocations = Snapshot.GetSocketLocations(TargetIndex);
+
+	for (int32 SocketIndex = 0; SocketIndex < Sockets.Num(); ++SocketIndex)
+	{
+		const FTargetInfo CurrentTarget = { Target, Sockets[SocketIndex] };
+
+		if (Context.CapturedTarget.Target != CurrentTarget)
+		{
+			OutTargetsData.Add(CreateTargetContext(Context, CurrentTarget, SocketLocations[SocketIndex]));
+		}
+	}
+}
+
+void UWeightedTargetHandler::RescoreIncrementalCandidates(FFindTargetContext& Context)
+{
+	//Candidates only contain the Targets validated in this call, so they can be safely accessed.
+	for (FTargetContext& Candidate : IncrementalCandidates)
+	{
+		Candidate = CreateTargetContext(Context, Candidate.Target, Candidate.Location);
+	}
+
+	PerformSolverPass(Context, /*inout*/IncrementalCandidates);
+}
+
+void UWeightedTargetHandler::ResetIncrementalState()
+{
+	IncrementalCandidates.Reset();
+	IncrementalTargetLocations.Reset();
+	IncrementalTarget = FTargetInfo::NULL_TARGET;
+	IncrementalFullUpdateTime = -FLT_MAX;
+}
+
+UWeightedTargetHandlerDetailedResponse* UWeightedTargetHandler::GenerateDetailedResponse(const FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData)
+{
+	auto* const Response = NewObject<UWeightedTargetHandlerDetailedResponse>(this, FName(TEXT("WeightedTargetHandler_DetailedResponse")), RF_StrongRefOnFrame | RF_Transient);
+
+	if (Response)
+	{
+		Response->Context = Context;
+		Response->TargetsData = MoveTemp(InTargetsData);
+	}
+
+	return Response;
+}
+
+/*******************************************************************************************/
+/******************************* Lightweight Targets ***************************************/
+/*******************************************************************************************/
+
+bool UWeightedTargetHandler::FilterByLightweightTarget(const FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData, FTargetHandle& OutHandle) const
+{
+	//Lightweight Targets can only be weighted by the batch solver and have no place in the detailed response.
+	float LightweightWeight = 0.f;
+
+	if (!bFindLightweightTargets || !CanUseBatchSolver() || Context.RequestParams.bGenerateDetailedResponse || !FindLightweightTarget(Context, OutHandle, LightweightWeight))
+	{
+		return false;
+	}
+
+	//Regular candidates worse than the lightweight Target can't win. The lightweight one is returned if none of the rest passes.
+	InOutTargetsData.RemoveAllSwap([LightweightWeight](const FTargetContext& TargetContext)
+		{
+			return TargetContext.Weight > LightweightWeight;
+		}, false);
+
+	return true;
+}
+
+bool UWeightedTargetHandler::FindLightweightTarget(const FFindTargetContext& Context, FTargetHandle& OutHandle, float& OutWeight) const
+{
+	LOT_SCOPED_EVENT(WTH_LightweightTargets);
+
+	const UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	const TArrayView<const FLightweightTarget> Targets = TargetManager.GetLightweightTargets();
+
+	TArray<FTargetContext> TargetsData;
+	TArray<float> Priorities;
+	TArray<int32> TargetIndices;
+
+	for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+	{
+		const FLightweightTarget& Target = Targets[TargetIndex];
+
+		if ((Target.TargetingChannels & TargetableChannels) == 0)
+		{
+			continue;
+		}
+
+		//There is no Target component, so only the location data is filled.
+		FTargetContext TargetContext;
+		TargetContext.Location = Target.GetSocketLocation();
+		const FVector Delta = TargetContext.Location - Context.ViewLocation;
+		TargetContext.DistanceSq = Delta.SizeSquared();
+
+		if (TargetContext.DistanceSq <= UE_KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		TargetContext.Direction = Delta * FMath::InvSqrt(TargetContext.DistanceSq);
+		const float CaptureRadius = CaptureRadiusScale * (Target.CaptureRadius > 0.f ? Target.CaptureRadius : DefaultCaptureRadius);
+
+		if ((bDistanceCheck && TargetContext.DistanceSq > FMath::Square(CaptureRadius)) || !IsTargetContextInRange(Context, TargetContext))
+		{
+			continue;
+		}
+
+		TargetsData.Add(TargetContext);
+		Priorities.Add(Target.Priority);
+		TargetIndices.Add(TargetIndex);
+	}
+
+	if (TargetsData.IsEmpty())
+	{
+		return false;
+	}
+
+	SolveTargetWeights(Context, MakeSolverParams(Context), Priorities, TargetsData);
+
+	TArray<int32> Order;
+	Order.Reserve(TargetsData.Num());
+
+	for (int32 i = 0; i < TargetsData.Num(); ++i)
+	{
+		Order.Add(i);
+	}
+
+	auto WeightPredicate = [&TargetsData](int32 lhs, int32 rhs)
+		{
+			return TargetsData[lhs].Weight < TargetsData[rhs].Weight;
+		};
+
+	Order.Heapify(WeightPredicate);
+
+	//Crowds might be large, so only the best few candidates are traced.
+	const int32 MaxTraces = FMath::Max(1, MaxLightweightLineOfSightTraces);
+
+	for (int32 NumChecked = 0; NumChecked < MaxTraces && Order.Num() > 0; ++NumChecked)
+	{
+		int32 Index;
+		Order.HeapPop(Index, WeightPredicate, false);
+		const FTargetContext& TargetContext = TargetsData[Index];
+
+		if (bScreenCapture && !IsTargetOnScreen(Context, TargetContext))
+		{
+			continue;
+		}
+
+		const FTargetHandle Handle = TargetManager.GetLightweightTargetHandle(TargetIndices[Index]);
+
+		if (bLineOfSightCheck)
+		{
+			//The trace ignores the instigator. Results are shared with other instigators through the cache.
+			FLineOfSightQuery Query = MakeLineOfSightQuery(Context.ViewLocation, FTargetInfo::NULL_TARGET, TargetContext.Location);
+			Query.LightweightTarget = Handle;
+			bool bIsVisible = false;
+
+			if (!FindCachedLineOfSight(Query, bIsVisible))
+			{
+				const AActor* BlockingActor = nullptr;
+				bIsVisible = LineOfSightTrace(Context.ViewLocation, TargetContext.Location, nullptr, &BlockingActor);
+				CacheLineOfSight(Query, bIsVisible, BlockingActor);
+			}
+
+			if (!bIsVisible)
+			{
+				continue;
+			}
+		}
+
+		OutHandle = Handle;
+		OutWeight = TargetContext.Weight;
+		return true;
+	}
+
+	return false;
+}
+
+/*******************************************************************************************/
+/*********************************** Helpers ***********************************************/
+/*******************************************************************************************/
 
 void UWeightedTargetHandler::HandleTargetUnlock(ETargetUnlockReason UnlockReason)
 {
@@ -361,17 +1914,49 @@ void UWeightedTargetHandler::HandleTargetUnlock(ETargetUnlockReason UnlockReason
 	}
 }
 
+void UWeightedTargetHandler::OnCapturedTargetLeftRadius()
+{
+	if (GetLockOnTargetComponent()->IsTargetLocked())
+	{
+		HandleTargetUnlock(ETargetUnlockReason::DistanceFailure);
+	}
+}
+
+FVector UWeightedTargetHandler::GetDistanceCheckViewLocation() const
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	LOT_NATIVE_EVENT(bIsGetPointOfViewOverridden, GetPointOfView, ViewLocation, ViewRotation);
+	return ViewLocation;
+}
+
 void UWeightedTargetHandler::TryFindTarget(bool bClearTargetIfFailed)
+{
+	ULockOnTargetComponent* const Instigator = GetLockOnTargetComponent();
+
+	//Many AI instigators may lose the same Target at once, so their requests are spread across frames.
+	if (Instigator->ShouldScheduleFindTarget())
+	{
+		UFindTargetScheduler::Get(*GetWorld()).ScheduleRequest(Instigator, FSimpleDelegate::CreateUObject(this, &UWeightedTargetHandler::PerformTryFindTarget, bClearTargetIfFailed));
+	}
+	else
+	{
+		PerformTryFindTarget(bClearTargetIfFailed);
+	}
+}
+
+void UWeightedTargetHandler::PerformTryFindTarget(bool bClearTargetIfFailed)
 {
 	if (GetLockOnTargetComponent()->CanCaptureTarget())
 	{
 		const FFindTargetRequestParams RequestParams;
 		FFindTargetContext Context = CreateFindTargetContext(EFindTargetContextMode::Find, RequestParams);
 		const FFindTargetRequestResponse Response = FindTargetBatched(Context);
+		const FTargetInfo Target = Context.Instigator->PromoteTargetHandlerResponse(Response);
 
-		if (Context.Instigator->CanTargetBeCaptured(Response.Target))
+		if (Context.Instigator->CanTargetBeCaptured(Target))
 		{
-			Context.Instigator->SetLockOnTargetManualByInfo(Response.Target);
+			Context.Instigator->SetLockOnTargetManualByInfo(Target);
 		}
 		else if (bClearTargetIfFailed)
 		{
@@ -393,8 +1978,15 @@ FFindTargetContext UWeightedTargetHandler::CreateFindTargetContext(EFindTargetCo
 	Context.InstigatorPawn = GetInstigatorPawn();
 	Context.PlayerController = GetPlayerController();
 
-	GetPointOfView(Context.ViewLocation, Context.ViewRotation);
+	LOT_NATIVE_EVENT(bIsGetPointOfViewOverridden, GetPointOfView, Context.ViewLocation, Context.ViewRotation);
 	Context.ViewRotationMatrix = FRotationMatrix::Make(Context.ViewRotation);
+	Context.CosViewConeAngle = FMath::Cos(FMath::DegreesToRadians(ViewConeAngle));
+	Context.CosPlayerInputAngularRange = FMath::Cos(FMath::DegreesToRadians(PlayerInputAngularRange));
+
+	if (bScreenCapture)
+	{
+		CaptureScreenData(Context);
+	}
 
 	if (Context.Instigator->IsTargetLocked())
 	{
@@ -417,8 +2009,19 @@ FTargetContext UWeightedTargetHandler::CreateTargetContext(const FFindTargetCont
 {
 	check(InTarget.TargetComponent);
 
+	FTargetSnapshot& Snapshot = UTargetManager::Get(*GetWorld()).GetTargetSnapshot();
+	const int32 TargetIndex = Snapshot.FindTargetIndex(InTarget.TargetComponent);
+	const FVector SocketLocation = TargetIndex != INDEX_NONE ? Snapshot.GetSocketLocation(TargetIndex, InTarget.Socket) : InTarget->GetSocketLocation(InTarget.Socket);
+
+	return CreateTargetContext(Context, InTarget, SocketLocation);
+}
+
+FTargetContext UWeightedTargetHandler::CreateTargetContext(const FFindTargetContext& Context, const FTargetInfo& InTarget, const FVector& SocketLocation) const
+{
+	check(InTarget.TargetComponent);
+
 	FTargetContext TargetContext{ InTarget };
-	TargetContext.Location = InTarget->GetSocketLocation(InTarget.Socket);
+	TargetContext.Location = SocketLocation;
 	const FVector Delta = TargetContext.Location - Context.ViewLocation;
 	TargetContext.DistanceSq = Delta.SizeSquared();
 
@@ -431,13 +2034,18 @@ FTargetContext UWeightedTargetHandler::CreateTargetContext(const FFindTargetCont
 }
 
 void UWeightedTargetHandler::CalcDeltaAngle2D(const FFindTargetContext& Context, FTargetContext& OutTargetContext) const
+{
+	OutTargetContext.DeltaAngle2D = FMath::RadiansToDegrees(FMath::Acos(CalcDeltaDirection2D(Context, OutTargetContext)));
+}
+
+float UWeightedTargetHandler::CalcDeltaDirection2D(const FFindTargetContext& Context, FTargetContext& OutTargetContext)
 {
 	const FVector Point = FMath::LinePlaneIntersection(Context.ViewLocation, OutTargetContext.Location, Context.CapturedTarget.Location, Context.ViewRotationMatrix.GetScaledAxis(EAxis::X));
 	const FVector Delta = Point - Context.CapturedTarget.Location;
 	const float DeltaX = Context.ViewRotationMatrix.GetScaledAxis(EAxis::Y) | Delta;
 	const float DeltaY = Context.ViewRotationMatrix.GetScaledAxis(EAxis::Z) | Delta;
 	OutTargetContext.DeltaDirection2D = FVector2D(DeltaX, -DeltaY).GetSafeNormal();
-	OutTargetContext.DeltaAngle2D = FMath::RadiansToDegrees(FMath::Acos(OutTargetContext.DeltaDirection2D | Context.PlayerInputDirection));
+	return FMath::Clamp(OutTargetContext.DeltaDirection2D | Context.PlayerInputDirection, -1.f, 1.f);
 }
 
 float UWeightedTargetHandler::GetTargetCaptureRadius(const UTargetComponent* InTarget) const
@@ -446,32 +2054,45 @@ float UWeightedTargetHandler::GetTargetCaptureRadius(const UTargetComponent* InT
 	return CaptureRadiusScale * (InTarget->bForceCustomCaptureRadius ? InTarget->CustomCaptureRadius : DefaultCaptureRadius);
 }
 
-bool UWeightedTargetHandler::IsTargetOnScreen(const FFindTargetContext& Context, const FTargetContext& TargetContext) const
+void UWeightedTargetHandler::CaptureScreenData(FFindTargetContext& Context) const
 {
-	//True for non-player controlled owners.
-	bool bResult = true;
+	const ULocalPlayer* const LocalPlayer = Context.PlayerController ? Context.PlayerController->GetLocalPlayer() : nullptr;
 
-	if (Context.PlayerController)
+	if (!LocalPlayer || !LocalPlayer->ViewportClient)
 	{
-		FVector2D ScreenPosition;
+		return;
+	}
 
-		if (Context.PlayerController->ProjectWorldLocationToScreen(TargetContext.Location, ScreenPosition, true))
-		{
-			const FVector2D ScreenSize = UWidgetLayoutLibrary::GetPlayerScreenWidgetGeometry(Context.PlayerController).GetAbsoluteSize();
+	FSceneViewProjectionData ProjectionData;
 
-			//Percent to ratio.
-			const FVector2D OffsetRatio = ScreenOffset / 100.f;
-			const float XOffset = ScreenSize.X * OffsetRatio.X;
-			const float YOffset = ScreenSize.Y * OffsetRatio.Y;
+	if (LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData))
+	{
+		//Locations are transformed relative to the view to keep the precision in large worlds.
+		Context.ScreenMatrix = FMatrix44f(FTranslationMatrix(Context.ViewLocation) * ProjectionData.ComputeViewProjectionMatrix());
 
-			bResult = ScreenPosition.X > XOffset				//Left
-				&& ScreenPosition.X < (ScreenSize.X - XOffset)	//Right
-				&& ScreenPosition.Y > YOffset					//Top
-				&& ScreenPosition.Y < (ScreenSize.Y - YOffset);	//Bottom
-		}
+		//Percent of both sides to NDC.
+		Context.ScreenLimits = FVector2f(1.f - ScreenOffset.X / 50.f, 1.f - ScreenOffset.Y / 50.f);
+		Context.bHasScreenData = true;
+	}
+}
+
+bool UWeightedTargetHandler::IsTargetOnScreen(const FFindTargetContext& Context, const FTargetContext& TargetContext) const
+{
+	//True for non-player controlled owners.
+	if (!Context.bHasScreenData)
+	{
+		return true;
+	}
+
+	const FVector4f Clip = Context.ScreenMatrix.TransformFVector4(FVector4f(FVector3f(TargetContext.Location - Context.ViewLocation), 1.f));
+
+	//Locations behind the view can't be projected and aren't rejected, like with ProjectWorldLocationToScreen().
+	if (Clip.W <= 0.f)
+	{
+		return true;
 	}
 
-	return bResult;
+	return FMath::Abs(Clip.X) < Clip.W * Context.ScreenLimits.X && FMath::Abs(Clip.Y) < Clip.W * Context.ScreenLimits.Y;
 }
 
 void UWeightedTargetHandler::GetPointOfView_Implementation(FVector& OutLocation, FRotator& OutRotation) const
@@ -513,18 +2134,181 @@ void UWeightedTargetHandler::OnLineOfSightTimerExpired()
 	HandleTargetUnlock(ETargetUnlockReason::LineOfSightFailure);
 }
 
-bool UWeightedTargetHandler::LineOfSightTrace(const FVector& From, const FVector& To, const AActor* const TargetToIgnore) const
+bool UWeightedTargetHandler::LineOfSightTrace(const FVector& From, const FVector& To, const AActor* const TargetToIgnore, const AActor** OutBlockingActor) const
 {
 	bool bOutSuccess = false;
 
 	if (UWorld* const World = GetWorld())
 	{
 		FHitResult HitRes;
-		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT_NAME_ONLY(LockOnTargetTrace));
-		QueryParams.AddIgnoredActor(TargetToIgnore);
-		QueryParams.AddIgnoredActor(GetLockOnTargetComponent()->GetOwner());
-		bOutSuccess = !World->LineTraceSingleByChannel(HitRes, From, To, TraceCollisionChannel, QueryParams);
+		bOutSuccess = !World->LineTraceSingleByChannel(HitRes, From, To, TraceCollisionChannel, MakeLineOfSightQueryParams(TargetToIgnore));
+
+		if (OutBlockingActor)
+		{
+			*OutBlockingActor = bOutSuccess ? nullptr : HitRes.GetActor();
+		}
 	}
 
 	return bOutSuccess;
 }
+
+FCollisionQueryParams UWeightedTargetHandler::MakeLineOfSightQueryParams(const AActor* const TargetToIgnore) const
+{
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT_NAME_ONLY(LockOnTargetTrace));
+	QueryParams.AddIgnoredActor(TargetToIgnore);
+	QueryParams.AddIgnoredActor(GetLockOnTargetComponent()->GetOwner());
+	return QueryParams;
+}
+
+bool UWeightedTargetHandler::CachedLineOfSightTrace(const FVector& From, const FTargetInfo& Target, const FVector& TargetLocation) const
+{
+	const FLineOfSightQuery Query = MakeLineOfSightQuery(From, Target, TargetLocation);
+	bool bIsVisible = false;
+
+	if (!FindCachedLineOfSight(Query, bIsVisible))
+	{
+		const AActor* BlockingActor = nullptr;
+		bIsVisible = LineOfSightTrace(From, TargetLocation, Target->GetOwner(), &BlockingActor);
+		CacheLineOfSight(Query, bIsVisible, BlockingActor);
+	}
+
+	return bIsVisible;
+}
+
+FLineOfSightQuery UWeightedTargetHandler::MakeLineOfSightQuery(const FVector& From, const FTargetInfo& Target, const FVector& TargetLocation) const
+{
+	FLineOfSightQuery Query;
+	Query.Target = Target.TargetComponent;
+	Query.Socket = Target.Socket;
+	Query.Channel = TraceCollisionChannel;
+
+	//The trace ignores the instigator. MakeLineOfSightQueryParams().
+	Query.IgnoredActor = GetLockOnTargetComponent()->GetOwner();
+	Query.ViewLocation = From;
+	Query.TargetLocation = TargetLocation;
+	return Query;
+}
+
+bool UWeightedTargetHandler::FindCachedLineOfSight(const FLineOfSightQuery& Query, bool& bOutVisible) const
+{
+	UWorld* const World = GetWorld();
+
+	if (LineOfSightCacheDuration <= 0.f || !World)
+	{
+		return false;
+	}
+
+	return UTargetManager::Get(*World).GetLineOfSightCache().Find(Query, World->GetTimeSeconds(), LineOfSightCacheDuration, LineOfSightCacheTolerance, bOutVisible);
+}
+
+void UWeightedTargetHandler::CacheLineOfSight(const FLineOfSightQuery& Query, bool bIsVisible, const AActor* BlockingActor) const
+{
+	//Results are shared by all instigators, so they're stored even if this handler doesn't read them.
+	if (UWorld* const World = GetWorld())
+	{
+		UTargetManager::Get(*World).GetLineOfSightCache().Store(Query, World->GetTimeSeconds(), bIsVisible, BlockingActor);
+	}
+}
+
+void UWeightedTargetHandler::AsyncLineOfSightTrace(const FLineOfSightQuery& Query, const AActor* const TargetToIgnore)
+{
+	UWorld* const World = GetWorld();
+
+	if (!World || World->IsTraceHandleValid(PendingLineOfSightTrace, false))
+	{
+		return;
+	}
+
+	if (!LineOfSightTraceDelegate.IsBound())
+	{
+		LineOfSightTraceDelegate.BindUObject(this, &UWeightedTargetHandler::OnAsyncLineOfSightTraceDone);
+	}
+
+	PendingLineOfSightQuery = Query;
+	PendingLineOfSightTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Query.ViewLocation, Query.TargetLocation, TraceCollisionChannel, MakeLineOfSightQueryParams(TargetToIgnore), FCollisionResponseParams::DefaultResponseParam, &LineOfSightTraceDelegate);
+}
+
+void UWeightedTargetHandler::OnAsyncLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	//Stale result, e.g. the Target has been unlocked since the request.
+	if (TraceHandle != PendingLineOfSightTrace)
+	{
+		return;
+	}
+
+	PendingLineOfSightTrace = FTraceHandle();
+
+	const FHitResult* const BlockingHit = FHitResult::GetFirstBlockingHit(TraceDatum.OutHits);
+	const bool bIsVisible = BlockingHit == nullptr;
+	CacheLineOfSight(PendingLineOfSightQuery, bIsVisible, BlockingHit ? BlockingHit->GetActor() : nullptr);
+
+	if (GetLockOnTargetComponent()->IsTargetLocked())
+	{
+		ApplyLineOfSightResult(PendingLineOfSightQuery, bIsVisible);
+	}
+}
+
+float UWeightedTargetHandler::GetLineOfSightCheckInterval() const
+{
+	return bAdaptiveCheckInterval ? AdaptiveCheckInterval : CheckInterval;
+}
+
+void UWeightedTargetHandler::ApplyLineOfSightResult(const FLineOfSightQuery& Query, bool bIsVisible)
+{
+	if (bIsVisible)
+	{
+		StopLineOfSightTimer();
+	}
+	else
+	{
+		StartLineOfSightTimer();
+	}
+
+	if (!bAdaptiveCheckInterval)
+	{
+		return;
+	}
+
+	const float Time = GetWorld()->GetTimeSeconds();
+	const FVector Direction = (Query.TargetLocation - Query.ViewLocation).GetSafeNormal();
+
+	//The Target moving across the view is likely to get in or out of cover. Movement along the view barely changes the occlusion.
+	float AngularSpeed = 0.f;
+	const float ElapsedTime = Time - LastLineOfSightTime;
+
+	if (!LastLineOfSightDirection.IsZero() && ElapsedTime > UE_KINDA_SMALL_NUMBER)
+	{
+		const float DeltaAngle = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Direction | LastLineOfSightDirection, -1.f, 1.f)));
+		AngularSpeed = DeltaAngle / ElapsedTime;
+	}
+
+	if (bIsVisible != bLastLineOfSightVisible)
+	{
+		LineOfSightResultTime = Time;
+		bLastLineOfSightVisible = bIsVisible;
+	}
+
+	LastLineOfSightTime = Time;
+	LastLineOfSightDirection = Direction;
+
+	//Only the Target that stays visible is traced less often. The occluded one falls back to the base interval.
+	if (!bIsVisible)
+	{
+		AdaptiveCheckInterval = CheckInterval;
+		return;
+	}
+
+	const float StableAlpha = FMath::Clamp((Time - LineOfSightResultTime) / AdaptiveStableTime, 0.f, 1.f);
+	const float MotionAlpha = FMath::Clamp(AngularSpeed / AdaptiveAngularSpeed, 0.f, 1.f);
+	AdaptiveCheckInterval = FMath::Lerp(CheckInterval, FMath::Max(CheckInterval, MaxCheckInterval), StableAlpha * (1.f - MotionAlpha));
+}
+
+void UWeightedTargetHandler::ResetAdaptiveLineOfSight()
+{
+	//A new Target starts at the base interval.
+	AdaptiveCheckInterval = CheckInterval;
+	LineOfSightResultTime = GetWorld()->GetTimeSeconds();
+	LastLineOfSightTime = LineOfSightResultTime;
+	LastLineOfSightDirection = FVector::ZeroVector;
+	bLastLineOfSightVisible = true;
+}
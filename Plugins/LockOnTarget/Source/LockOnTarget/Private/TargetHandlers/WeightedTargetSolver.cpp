@@ -0,0 +1,131 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "WeightedTargetSolver.h"
+#include "Math/VectorRegister.h"
+
+void FWeightedTargetSolverData::Init(int32 InNum)
+{
+	NumCandidates = InNum;
+	const int32 NumPadded = Align(InNum, VectorWidth);
+
+	DistanceSq.SetNumZeroed(NumPadded);
+	CosDeltaAngle.SetNumZeroed(NumPadded);
+	DeltaAngle2D.SetNumZeroed(NumPadded);
+	Priority.SetNumZeroed(NumPadded);
+	Weight.SetNumZeroed(NumPadded);
+}
+
+namespace WeightedTargetSolver
+{
+	/**
+	 * Vectorized acos approximation. Max error is ~6.7e-5 rad.
+	 * Abramowitz & Stegun 4.4.45: acos(x) = sqrt(1 - x) * P(x), x in [0, 1]; acos(-x) = PI - acos(x).
+	 */
+	FORCEINLINE VectorRegister4Float VectorAcos(const VectorRegister4Float& X)
+	{
+		static const VectorRegister4Float C0 = MakeVectorRegisterFloatConstant(1.5707288f, 1.5707288f, 1.5707288f, 1.5707288f);
+		static const VectorRegister4Float C1 = MakeVectorRegisterFloatConstant(-0.2121144f, -0.2121144f, -0.2121144f, -0.2121144f);
+		static const VectorRegister4Float C2 = MakeVectorRegisterFloatConstant(0.0742610f, 0.0742610f, 0.0742610f, 0.0742610f);
+		static const VectorRegister4Float C3 = MakeVectorRegisterFloatConstant(-0.0187293f, -0.0187293f, -0.0187293f, -0.0187293f);
+
+		const VectorRegister4Float One = VectorOneFloat();
+		const VectorRegister4Float Clamped = VectorMin(VectorMax(X, VectorNegate(One)), One);
+		const VectorRegister4Float AbsX = VectorAbs(Clamped);
+
+		VectorRegister4Float Poly = VectorMultiplyAdd(C3, AbsX, C2);
+		Poly = VectorMultiplyAdd(Poly, AbsX, C1);
+		Poly = VectorMultiplyAdd(Poly, AbsX, C0);
+
+		const VectorRegister4Float Result = VectorMultiply(VectorSqrt(VectorSubtract(One, AbsX)), Poly);
+		const VectorRegister4Float Mirrored = VectorSubtract(GlobalVectorConstants::Pi, Result);
+
+		return VectorSelect(VectorCompareLT(Clamped, VectorZeroFloat()), Mirrored, Result);
+	}
+
+	FORCEINLINE VectorRegister4Float ClampFactor(const VectorRegister4Float& Ratio, const VectorRegister4Float& MinFactor)
+	{
+		return VectorMin(VectorMax(Ratio, MinFactor), VectorOneFloat());
+	}
+
+	template<uint8 TermMask>
+	void SolveKernel(const FWeightedTargetSolverParams& Params, FWeightedTargetSolverData& Data)
+	{
+		constexpr bool bDistanceTerm = (TermMask & EWeightedTargetSolverTerm::Distance) != 0;
+		constexpr bool bDeltaAngleTerm = (TermMask & EWeightedTargetSolverTerm::DeltaAngle) != 0;
+		constexpr bool bPlayerInputTerm = (TermMask & EWeightedTargetSolverTerm::PlayerInput) != 0;
+		constexpr bool bPriorityTerm = (TermMask & EWeightedTargetSolverTerm::Priority) != 0;
+
+		const VectorRegister4Float MinFactor = VectorSetFloat1(Params.MinimumFactorThreshold);
+		const VectorRegister4Float DistanceScale = VectorSetFloat1(Params.DistanceScale);
+		const VectorRegister4Float DeltaAngleScale = VectorSetFloat1(Params.DeltaAngleScale);
+		const VectorRegister4Float PlayerInputScale = VectorSetFloat1(Params.PlayerInputScale);
+		const VectorRegister4Float PriorityScale = VectorSetFloat1(Params.PriorityScale);
+		const VectorRegister4Float InvDistanceMaxFactorSq = VectorSetFloat1(Params.InvDistanceMaxFactorSq);
+		const VectorRegister4Float InvDeltaAngleMaxFactorRad = VectorSetFloat1(Params.InvDeltaAngleMaxFactorRad);
+		const VectorRegister4Float InvPlayerInputAngularRange = VectorSetFloat1(Params.InvPlayerInputAngularRange);
+
+		const int32 NumPadded = Data.Weight.Num();
+
+		for (int32 i = 0; i < NumPadded; i += FWeightedTargetSolverData::VectorWidth)
+		{
+			VectorRegister4Float Weight = VectorZeroFloat();
+
+			if constexpr (bDistanceTerm)
+			{
+				const VectorRegister4Float Ratio = VectorMultiply(VectorLoad(&Data.DistanceSq[i]), InvDistanceMaxFactorSq);
+				Weight = VectorMultiplyAdd(ClampFactor(Ratio, MinFactor), DistanceScale, Weight);
+			}
+
+			if constexpr (bDeltaAngleTerm)
+			{
+				const VectorRegister4Float Ratio = VectorMultiply(VectorAcos(VectorLoad(&Data.CosDeltaAngle[i])), InvDeltaAngleMaxFactorRad);
+				Weight = VectorMultiplyAdd(ClampFactor(Ratio, MinFactor), DeltaAngleScale, Weight);
+			}
+
+			if constexpr (bPlayerInputTerm)
+			{
+				const VectorRegister4Float Ratio = VectorMultiply(VectorLoad(&Data.DeltaAngle2D[i]), InvPlayerInputAngularRange);
+				Weight = VectorMultiplyAdd(ClampFactor(Ratio, MinFactor), PlayerInputScale, Weight);
+			}
+
+			if constexpr (bPriorityTerm)
+			{
+				Weight = VectorMultiplyAdd(ClampFactor(VectorLoad(&Data.Priority[i]), MinFactor), PriorityScale, Weight);
+			}
+
+			VectorStore(Weight, &Data.Weight[i]);
+		}
+	}
+
+	//Indexed by the term mask.
+	static const FKernel Kernels[EWeightedTargetSolverTerm::All + 1] =
+	{
+		&SolveKernel<0>,
+		&SolveKernel<1>,
+		&SolveKernel<2>,
+		&SolveKernel<3>,
+		&SolveKernel<4>,
+		&SolveKernel<5>,
+		&SolveKernel<6>,
+		&SolveKernel<7>,
+		&SolveKernel<8>,
+		&SolveKernel<9>,
+		&SolveKernel<10>,
+		&SolveKernel<11>,
+		&SolveKernel<12>,
+		&SolveKernel<13>,
+		&SolveKernel<14>,
+		&SolveKernel<15>
+	};
+
+	FKernel GetKernel(uint8 TermMask)
+	{
+		check(TermMask <= EWeightedTargetSolverTerm::All);
+		return Kernels[TermMask & EWeightedTargetSolverTerm::All];
+	}
+
+	void Solve(const FWeightedTargetSolverParams& Params, FWeightedTargetSolverData& Data)
+	{
+		GetKernel(Params.TermMask)(Params, Data);
+	}
+}
@@ -0,0 +1,82 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * Weight terms of the UWeightedTargetHandler. Used to select the solver kernel.
+ */
+namespace EWeightedTargetSolverTerm
+{
+	enum Type : uint8
+	{
+		None = 0,
+		Distance = 1 << 0,
+		DeltaAngle = 1 << 1,
+		PlayerInput = 1 << 2,
+		Priority = 1 << 3,
+		All = Distance | DeltaAngle | PlayerInput | Priority
+	};
+}
+
+/**
+ * Precomputed coefficients of the UWeightedTargetHandler weight terms.
+ * A term is disabled if its scale is 0.
+ */
+struct FWeightedTargetSolverParams
+{
+	//Enabled terms. EWeightedTargetSolverTerm. Matches the non-zero scales.
+	uint8 TermMask = EWeightedTargetSolverTerm::None;
+
+	//PureDefaultWeight * TermWeight / WeightSum.
+	float DistanceScale = 0.f;
+	float DeltaAngleScale = 0.f;
+	float PlayerInputScale = 0.f;
+	float PriorityScale = 0.f;
+
+	//Ratio multipliers.
+	float InvDistanceMaxFactorSq = 0.f;
+	float InvDeltaAngleMaxFactorRad = 0.f;
+	float InvPlayerInputAngularRange = 0.f;
+
+	float MinimumFactorThreshold = 0.f;
+};
+
+/**
+ * Structure-of-arrays candidate data for the batch solver.
+ * Arrays are padded with zeros to a multiple of the vector width.
+ * Allocated on the FMemStack, so a FMemMark must be in scope.
+ */
+struct FWeightedTargetSolverData
+{
+	static constexpr int32 VectorWidth = 4;
+
+	void Init(int32 InNum);
+	int32 Num() const { return NumCandidates; }
+
+	TArray<float, TMemStackAllocator<>> DistanceSq;
+	TArray<float, TMemStackAllocator<>> CosDeltaAngle;
+	TArray<float, TMemStackAllocator<>> DeltaAngle2D;
+	TArray<float, TMemStackAllocator<>> Priority;
+	TArray<float, TMemStackAllocator<>> Weight;
+
+private:
+
+	int32 NumCandidates = 0;
+};
+
+namespace WeightedTargetSolver
+{
+	using FKernel = void(*)(const FWeightedTargetSolverParams& Params, FWeightedTargetSolverData& Data);
+
+	/** Returns the kernel specialized for the enabled terms. The kernel has no per-candidate branches. */
+	FKernel GetKernel(uint8 TermMask);
+
+	/**
+	 * Calculates weights for all candidates by the kernel of Params.TermMask.
+	 * Matches UWeightedTargetHandler::CalculateTargetWeight_Implementation() within the acos approximation error.
+	 */
+	void Solve(const FWeightedTargetSolverParams& Params, FWeightedTargetSolverData& Data);
+}
@@ -1,9 +1,16 @@
 // Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
 
 #include "TargetManager.h"
+#include "TargetComponent.h"
+#include "LockOnTargetDefines.h"
 #include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
 
 UTargetManager::UTargetManager()
+	: TargetsVersion(0)
+	, TargetDataUpdateFrame(MAX_uint64)
+	, bTargetDataDirty(true)
 {
 	//Do something.
 }
@@ -18,6 +25,8 @@ void UTargetManager::OnWorldBeginPlay(UWorld& InWorld)
 {
 	Super::OnWorldBeginPlay(InWorld);
 	RegisteredTargets.Reserve(30);
+	RegisteredTargetSlots.Reserve(30);
+	TargetSlots.Reserve(30);
 }
 
 bool UTargetManager::DoesSupportWorldType(const EWorldType::Type Type) const
@@ -27,17 +36,436 @@ bool UTargetManager::DoesSupportWorldType(const EWorldType::Type Type) const
 
 bool UTargetManager::RegisterTarget(UTargetComponent* Target)
 {
-	bool bHasAlreadyBeen = true;
-
-	if (Target)
+	if (!Target || IsTargetRegistered(Target))
 	{
-		RegisteredTargets.Add(Target, &bHasAlreadyBeen);
+		return false;
 	}
 
-	return !bHasAlreadyBeen;
+	const int32 SlotIndex = FreeTargetSlots.Num() > 0 ? FreeTargetSlots.Pop(false) : TargetSlots.AddDefaulted();
+	FTargetSlot& Slot = TargetSlots[SlotIndex];
+	Slot.DenseIndex = RegisteredTargets.Add(Target);
+	RegisteredTargetSlots.Add(SlotIndex);
+
+	Target->TargetHandle = { SlotIndex, Slot.Generation };
+
+	//The spatial index is only updated for the moved Targets.
+	WatchTargetTransform(Slot, SlotIndex, Target);
+
+	SpatialGrid.Add(Target);
+	InvalidateTargetData();
+	++TargetsVersion;
+
+	return true;
 }
 
 bool UTargetManager::UnregisterTarget(UTargetComponent* Target)
 {
-	return RegisteredTargets.Remove(Target) > 0;
+	if (!IsTargetRegistered(Target))
+	{
+		return false;
+	}
+
+	FTargetSlot& Slot = TargetSlots[Target->TargetHandle.Index];
+	const int32 DenseIndex = Slot.DenseIndex;
+	const int32 LastIndex = RegisteredTargets.Num() - 1;
+
+	//Move the last Target into the freed place.
+	if (DenseIndex != LastIndex)
+	{
+		TargetSlots[RegisteredTargetSlots[LastIndex]].DenseIndex = DenseIndex;
+	}
+
+	RegisteredTargets.RemoveAtSwap(DenseIndex, 1, false);
+	RegisteredTargetSlots.RemoveAtSwap(DenseIndex, 1, false);
+
+	UnwatchTargetTransform(Slot);
+
+	//Invalidate all handles to the slot.
+	Slot.DenseIndex = INDEX_NONE;
+	++Slot.Generation;
+	Slot.bMoved = false;
+	FreeTargetSlots.Add(Target->TargetHandle.Index);
+	Target->TargetHandle.Reset();
+
+	SpatialGrid.Remove(Target);
+	LineOfSightCache.RemoveTarget(Target);
+	InvalidateTargetData();
+	++TargetsVersion;
+
+	return true;
+}
+
+bool UTargetManager::IsTargetRegistered(const UTargetComponent* Target) const
+{
+	return Target && GetTargetIndex(Target->TargetHandle) != INDEX_NONE;
+}
+
+int32 UTargetManager::GetTargetIndex(const FTargetHandle& Handle) const
+{
+	if (TargetSlots.IsValidIndex(Handle.Index))
+	{
+		const FTargetSlot& Slot = TargetSlots[Handle.Index];
+		return Slot.Generation == Handle.Generation ? Slot.DenseIndex : INDEX_NONE;
+	}
+
+	return INDEX_NONE;
+}
+
+UTargetComponent* UTargetManager::GetTarget(const FTargetHandle& Handle) const
+{
+	const int32 DenseIndex = GetTargetIndex(Handle);
+	return DenseIndex != INDEX_NONE ? RegisteredTargets[DenseIndex] : nullptr;
+}
+
+/*******************************************************************************************/
+/*****************************  Lightweight Targets  ***************************************/
+/*******************************************************************************************/
+
+FTargetHandle UTargetManager::RegisterLightweightTarget(const FLightweightTarget& Target, FPromoteLightweightTarget&& Promoter)
+{
+	const int32 SlotIndex = FreeLightweightSlots.Num() > 0 ? FreeLightweightSlots.Pop(false) : LightweightSlots.AddDefaulted();
+	FTargetSlot& Slot = LightweightSlots[SlotIndex];
+	Slot.DenseIndex = LightweightTargets.Add(Target);
+	LightweightPromoters.Add(MoveTemp(Promoter));
+	LightweightTargetSlots.Add(SlotIndex);
+
+	return { SlotIndex, Slot.Generation };
+}
+
+bool UTargetManager::UnregisterLightweightTarget(const FTargetHandle& Handle)
+{
+	if (!LightweightSlots.IsValidIndex(Handle.Index) || LightweightSlots[Handle.Index].Generation != Handle.Generation)
+	{
+		return false;
+	}
+
+	FTargetSlot& Slot = LightweightSlots[Handle.Index];
+	const int32 DenseIndex = Slot.DenseIndex;
+	const int32 LastIndex = LightweightTargets.Num() - 1;
+
+	//Move the last lightweight Target into the freed place.
+	if (DenseIndex != LastIndex)
+	{
+		LightweightSlots[LightweightTargetSlots[LastIndex]].DenseIndex = DenseIndex;
+	}
+
+	LightweightTargets.RemoveAtSwap(DenseIndex, 1, false);
+	LightweightPromoters.RemoveAtSwap(DenseIndex, 1, false);
+	LightweightTargetSlots.RemoveAtSwap(DenseIndex, 1, false);
+
+	//Invalidate all handles to the slot.
+	Slot.DenseIndex = INDEX_NONE;
+	++Slot.Generation;
+	FreeLightweightSlots.Add(Handle.Index);
+
+	return true;
+}
+
+FLightweightTarget* UTargetManager::FindLightweightTarget(const FTargetHandle& Handle)
+{
+	if (LightweightSlots.IsValidIndex(Handle.Index))
+	{
+		const FTargetSlot& Slot = LightweightSlots[Handle.Index];
+		return Slot.Generation == Handle.Generation ? &LightweightTargets[Slot.DenseIndex] : nullptr;
+	}
+
+	return nullptr;
+}
+
+FTargetHandle UTargetManager::GetLightweightTargetHandle(int32 DenseIndex) const
+{
+	check(LightweightTargets.IsValidIndex(DenseIndex));
+	const int32 SlotIndex = LightweightTargetSlots[DenseIndex];
+	return { SlotIndex, LightweightSlots[SlotIndex].Generation };
+}
+
+UTargetComponent* UTargetManager::PromoteLightweightTarget(const FTargetHandle& Handle)
+{
+	if (!FindLightweightTarget(Handle))
+	{
+		return nullptr;
+	}
+
+	//The promoter might (un)register other lightweight Targets, so the delegate is copied.
+	const FPromoteLightweightTarget Promoter = LightweightPromoters[LightweightSlots[Handle.Index].DenseIndex];
+	UTargetComponent* const Target = Promoter.IsBound() ? Promoter.Execute(Handle) : nullptr;
+
+	if (!IsTargetRegistered(Target))
+	{
+		return nullptr;
+	}
+
+	//The entity is now represented by the actor.
+	UnregisterLightweightTarget(Handle);
+	return Target;
+}
+
+TStatId UTargetManager::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTargetManager, STATGROUP_Tickables);
+}
+
+/*******************************************************************************************/
+/*******************************  Locked Pairs  ********************************************/
+/*******************************************************************************************/
+
+void UTargetManager::WatchLockedTarget(const UObject* Owner, const AActor* Instigator, UTargetComponent* Target, float Radius, FLockedTargetViewLocation&& GetViewLocation, FSimpleDelegate&& OnExit)
+{
+	check(Owner && Instigator && Target);
+
+	FLockedPair* Pair = LockedPairs.FindByPredicate([Owner](const FLockedPair& LockedPair) { return LockedPair.Owner == Owner; });
+
+	if (!Pair)
+	{
+		Pair = &LockedPairs.AddDefaulted_GetRef();
+		Pair->Owner = Owner;
+	}
+
+	Pair->Instigator = Instigator;
+	Pair->Target = Target;
+	Pair->Radius = Radius;
+	Pair->GetViewLocation = MoveTemp(GetViewLocation);
+	Pair->OnExit = MoveTemp(OnExit);
+
+	//Checked in the next tick.
+	Pair->NextCheckTime = 0.0;
+	Pair->LastCheckTime = -1.0;
+}
+
+void UTargetManager::UnwatchLockedTarget(const UObject* Owner)
+{
+	const int32 Index = LockedPairs.IndexOfByPredicate([Owner](const FLockedPair& LockedPair) { return LockedPair.Owner == Owner; });
+
+	if (Index != INDEX_NONE)
+	{
+		LockedPairs.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+void UTargetManager::Tick(float DeltaTime)
+{
+	if (LockedPairs.IsEmpty())
+	{
+		return;
+	}
+
+	LOT_SCOPED_EVENT(TargetManager_CheckLockedPairs);
+
+	const double Time = GetWorld()->GetTimeSeconds();
+	TArray<FSimpleDelegate, TInlineAllocator<4>> ExitEvents;
+
+	for (int32 i = LockedPairs.Num() - 1; i >= 0; --i)
+	{
+		FLockedPair& Pair = LockedPairs[i];
+
+		//Idle pairs cost a single comparison.
+		if (Time < Pair.NextCheckTime)
+		{
+			continue;
+		}
+
+		if (!CheckLockedPair(Pair, Time))
+		{
+			ExitEvents.Add(MoveTemp(Pair.OnExit));
+			LockedPairs.RemoveAtSwap(i, 1, false);
+		}
+	}
+
+	//Listeners may watch a new pair.
+	for (FSimpleDelegate& ExitEvent : ExitEvents)
+	{
+		ExitEvent.ExecuteIfBound();
+	}
+}
+
+bool UTargetManager::CheckLockedPair(FLockedPair& Pair, double Time) const
+{
+	const AActor* const Instigator = Pair.Instigator.Get();
+	const UTargetComponent* const Target = Pair.Target.Get();
+	const AActor* const TargetActor = Target ? Target->GetOwner() : nullptr;
+
+	if (!Instigator || !TargetActor || !Pair.GetViewLocation.IsBound())
+	{
+		//Invalid pairs are removed silently. Target exceptions are dispatched separately.
+		Pair.OnExit.Unbind();
+		return false;
+	}
+
+	const FVector ViewLocation = Pair.GetViewLocation.Execute();
+	const float Distance = FVector::Dist(ViewLocation, TargetActor->GetActorLocation());
+
+	if (Distance > Pair.Radius)
+	{
+		return false;
+	}
+
+	//The view speed is unknown until the second check, so check again in the next tick.
+	if (Pair.LastCheckTime < 0.0 || Time <= Pair.LastCheckTime)
+	{
+		Pair.LastViewLocation = ViewLocation;
+		Pair.LastCheckTime = Time;
+		Pair.NextCheckTime = Time;
+		return true;
+	}
+
+	//The view might move independently of the pawns, e.g. a camera boom or a camera animation.
+	const float ViewSpeed = FVector::Dist(ViewLocation, Pair.LastViewLocation) / (Time - Pair.LastCheckTime);
+	Pair.LastViewLocation = ViewLocation;
+	Pair.LastCheckTime = Time;
+
+	//The earliest time the pair could cross the radius.
+	const float MaxRelativeSpeed = Instigator->GetVelocity().Size() + TargetActor->GetVelocity().Size() + ViewSpeed;
+	const float Margin = Pair.Radius - Distance;
+	const float Delay = MaxRelativeSpeed > UE_KINDA_SMALL_NUMBER ? Margin / MaxRelativeSpeed : MaxLockedPairCheckDelay;
+	Pair.NextCheckTime = Time + FMath::Min(Delay, MaxLockedPairCheckDelay);
+
+	return true;
+}
+
+void UTargetManager::QueryTargets(const FVector& Origin, float Radius, const FVector& ConeDirection, float ConeHalfAngle, TArray<UTargetComponent*>& OutTargets, uint8 ChannelMask)
+{
+	UpdateTargetData();
+	SpatialGrid.Query(Origin, Radius, ConeDirection, ConeHalfAngle, OutTargets, ChannelMask);
+}
+
+void UTargetManager::RefreshTarget(UTargetComponent* Target)
+{
+	if (IsTargetRegistered(Target))
+	{
+		//The associated component might have changed.
+		const int32 SlotIndex = Target->TargetHandle.Index;
+		UnwatchTargetTransform(TargetSlots[SlotIndex]);
+		WatchTargetTransform(TargetSlots[SlotIndex], SlotIndex, Target);
+
+		SpatialGrid.Remove(Target);
+		SpatialGrid.Add(Target);
+		InvalidateTargetData();
+		++TargetsVersion;
+	}
+}
+
+float UTargetManager::GetMaxCustomCaptureRadius()
+{
+	UpdateTargetData();
+	float MaxCustomCaptureRadius = 0.f;
+
+	//Only a few Targets usually have the custom radius, so it's cheaper than tracking the radius changes.
+	for (const UTargetComponent* const Target : CustomCaptureRadiusTargets)
+	{
+		MaxCustomCaptureRadius = FMath::Max(MaxCustomCaptureRadius, Target->CustomCaptureRadius);
+	}
+
+	return MaxCustomCaptureRadius;
+}
+
+FTargetSnapshot& UTargetManager::GetTargetSnapshot()
+{
+	UpdateTargetData();
+	return TargetSnapshot;
+}
+
+void UTargetManager::OnTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 SlotIndex)
+{
+	FTargetSlot& Slot = TargetSlots[SlotIndex];
+
+	if (!Slot.bMoved && Slot.DenseIndex != INDEX_NONE)
+	{
+		Slot.bMoved = true;
+		MovedTargetSlots.Add(SlotIndex);
+	}
+}
+
+void UTargetManager::WatchTargetTransform(FTargetSlot& Slot, int32 SlotIndex, const UTargetComponent* Target)
+{
+	USceneComponent* const RootComponent = Target->GetOwner() ? Target->GetOwner()->GetRootComponent() : nullptr;
+
+	if (RootComponent)
+	{
+		Slot.RootComponent = RootComponent;
+		Slot.RootTransformUpdatedHandle = RootComponent->TransformUpdated.AddUObject(this, &UTargetManager::OnTargetTransformUpdated, SlotIndex);
+	}
+
+	//Sockets are evaluated on the associated component, which might move without the root.
+	USceneComponent* const AssociatedComponent = Target->GetAssociatedComponent();
+
+	if (AssociatedComponent && AssociatedComponent != RootComponent)
+	{
+		Slot.AssociatedComponent = AssociatedComponent;
+		Slot.AssociatedTransformUpdatedHandle = AssociatedComponent->TransformUpdated.AddUObject(this, &UTargetManager::OnTargetTransformUpdated, SlotIndex);
+	}
+}
+
+void UTargetManager::UnwatchTargetTransform(FTargetSlot& Slot)
+{
+	if (USceneComponent* const RootComponent = Slot.RootComponent.Get())
+	{
+		RootComponent->TransformUpdated.Remove(Slot.RootTransformUpdatedHandle);
+	}
+
+	if (USceneComponent* const AssociatedComponent = Slot.AssociatedComponent.Get())
+	{
+		AssociatedComponent->TransformUpdated.Remove(Slot.AssociatedTransformUpdatedHandle);
+	}
+
+	Slot.RootComponent.Reset();
+	Slot.RootTransformUpdatedHandle.Reset();
+	Slot.AssociatedComponent.Reset();
+	Slot.AssociatedTransformUpdatedHandle.Reset();
+}
+
+void UTargetManager::UpdateMovedTargets()
+{
+	if (MovedTargetSlots.IsEmpty())
+	{
+		return;
+	}
+
+	LOT_SCOPED_EVENT(TargetManager_UpdateMovedTargets);
+
+	for (const int32 SlotIndex : MovedTargetSlots)
+	{
+		FTargetSlot& Slot = TargetSlots[SlotIndex];
+
+		//The slot might have been freed since.
+		if (Slot.bMoved && Slot.DenseIndex != INDEX_NONE)
+		{
+			SpatialGrid.Update(RegisteredTargets[Slot.DenseIndex]);
+		}
+
+		Slot.bMoved = false;
+	}
+
+	MovedTargetSlots.Reset();
+}
+
+void UTargetManager::UpdateTargetData()
+{
+	//Cheap if nothing has moved, so the grid is kept up to date in every tick group.
+	UpdateMovedTargets();
+
+	//Rebuilt only on explicit invalidation, e.g. (un)registration, Sockets or channels change.
+	if (bTargetDataDirty)
+	{
+		LOT_SCOPED_EVENT(TargetManager_UpdateTargetData);
+
+		bTargetDataDirty = false;
+		TargetDataUpdateFrame = GFrameCounter;
+		CustomCaptureRadiusTargets.Reset();
+
+		for (UTargetComponent* const Target : RegisteredTargets)
+		{
+			if (Target->bForceCustomCaptureRadius)
+			{
+				CustomCaptureRadiusTargets.Add(Target);
+			}
+		}
+
+		TargetSnapshot.Build(RegisteredTargets, TargetSlots.Num());
+	}
+	else if (TargetDataUpdateFrame != GFrameCounter)
+	{
+		//Only the Targets queried in this frame will evaluate their data.
+		TargetDataUpdateFrame = GFrameCounter;
+		TargetSnapshot.BeginFrame();
+	}
 }
@@ -0,0 +1,251 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "TargetSnapshot.h"
+#include "TargetComponent.h"
+#include "LockOnTargetDefines.h"
+
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+
+void FTargetSnapshot::Build(TArrayView<UTargetComponent* const> InTargets, int32 NumHandleSlots)
+{
+	LOT_SCOPED_EVENT(TargetSnapshot_Build);
+
+	Reset();
+
+	const int32 NumTargets = InTargets.Num();
+	Targets.Reserve(NumTargets);
+	Channels.Reserve(NumTargets);
+	SocketStarts.Reserve(NumTargets);
+	SocketNums.Reserve(NumTargets);
+	SlotIndices.Init(INDEX_NONE, NumHandleSlots);
+
+	for (UTargetComponent* const Target : InTargets)
+	{
+		if (!Target || !Target->GetOwner())
+		{
+			continue;
+		}
+
+		const int32 TargetIndex = Targets.Add(Target);
+		const int32 SlotIndex = Target->GetTargetHandle().Index;
+
+		if (SlotIndices.IsValidIndex(SlotIndex))
+		{
+			SlotIndices[SlotIndex] = TargetIndex;
+		}
+
+		Channels.Add(Target->GetTargetingChannels());
+
+		const TArray<FName>& Sockets = Target->GetSockets();
+		SocketStarts.Add(SocketNames.Num());
+		SocketNums.Add(Sockets.Num());
+		SocketNames.Append(Sockets);
+
+		for (int32 Channel = 0; Channel < NumTargetingChannels; ++Channel)
+		{
+			if (Channels[TargetIndex] & (1 << Channel))
+			{
+				ChannelPartitions[Channel].Add(TargetIndex);
+			}
+		}
+	}
+
+	//Per-frame data is evaluated lazily.
+	ActorLocations.SetNumUninitialized(Targets.Num());
+	LastRenderTimes.SetNumUninitialized(Targets.Num());
+	Bounds.SetNumUninitialized(Targets.Num());
+	LocationStamps.SetNumZeroed(Targets.Num());
+	RenderTimeStamps.SetNumZeroed(Targets.Num());
+	BoundsStamps.SetNumZeroed(Targets.Num());
+	SocketStamps.SetNumZeroed(Targets.Num());
+	SocketLocations.SetNumUninitialized(SocketNames.Num());
+	FrameStamp = 1;
+}
+
+void FTargetSnapshot::BeginFrame()
+{
+	//Stamps are only reset on the wrap-around, so a new frame costs nothing regardless of the number of Targets.
+	if (++FrameStamp == 0)
+	{
+		FMemory::Memzero(LocationStamps.GetData(), LocationStamps.Num() * sizeof(uint32));
+		FMemory::Memzero(RenderTimeStamps.GetData(), RenderTimeStamps.Num() * sizeof(uint32));
+		FMemory::Memzero(BoundsStamps.GetData(), BoundsStamps.Num() * sizeof(uint32));
+		FMemory::Memzero(SocketStamps.GetData(), SocketStamps.Num() * sizeof(uint32));
+		FrameStamp = 1;
+	}
+}
+
+void FTargetSnapshot::Reset()
+{
+	Targets.Reset();
+	Channels.Reset();
+	ActorLocations.Reset();
+	LastRenderTimes.Reset();
+	Bounds.Reset();
+	LocationStamps.Reset();
+	RenderTimeStamps.Reset();
+	BoundsStamps.Reset();
+	SocketStamps.Reset();
+	SocketStarts.Reset();
+	SocketNums.Reset();
+	SocketNames.Reset();
+	SocketLocations.Reset();
+	SlotIndices.Reset();
+
+	for (TArray<int32>& Partition : ChannelPartitions)
+	{
+		Partition.Reset();
+	}
+}
+
+int32 FTargetSnapshot::FindTargetIndex(const UTargetComponent* Target) const
+{
+	if (!Target)
+	{
+		return INDEX_NONE;
+	}
+
+	//The handle generation isn't checked, the Target pointer is compared instead. The Target must be alive, use handles for the stored ones.
+	const int32 SlotIndex = Target->GetTargetHandle().Index;
+	const int32 Index = SlotIndices.IsValidIndex(SlotIndex) ? SlotIndices[SlotIndex] : INDEX_NONE;
+	return Index != INDEX_NONE && Targets[Index] == Target ? Index : INDEX_NONE;
+}
+
+void FTargetSnapshot::GatherTargetIndices(uint8 ChannelMask, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+
+	if (ChannelMask == 0)
+	{
+		return;
+	}
+
+	if (ChannelMask == static_cast<uint8>(ETargetingChannel::All))
+	{
+		//Targets without channels are excluded as well.
+		OutIndices.Reserve(Num());
+
+		for (int32 TargetIndex = 0; TargetIndex < Num(); ++TargetIndex)
+		{
+			if (Channels[TargetIndex])
+			{
+				OutIndices.Add(TargetIndex);
+			}
+		}
+
+		return;
+	}
+
+	if (FMath::IsPowerOfTwo(ChannelMask))
+	{
+		OutIndices = ChannelPartitions[FMath::CountTrailingZeros(static_cast<uint32>(ChannelMask))];
+		return;
+	}
+
+	//A Target can be in several partitions.
+	TBitArray<> GatheredIndices(false, Num());
+
+	for (int32 Channel = 0; Channel < NumTargetingChannels; ++Channel)
+	{
+		if (ChannelMask & (1 << Channel))
+		{
+			for (const int32 TargetIndex : ChannelPartitions[Channel])
+			{
+				if (!GatheredIndices[TargetIndex])
+				{
+					GatheredIndices[TargetIndex] = true;
+					OutIndices.Add(TargetIndex);
+				}
+			}
+		}
+	}
+}
+
+float FTargetSnapshot::GetPriority(int32 Index) const
+{
+	return Targets[Index]->Priority;
+}
+
+float FTargetSnapshot::GetCaptureRadius(int32 Index, float DefaultCaptureRadius) const
+{
+	const UTargetComponent* const Target = Targets[Index];
+	return Target->bForceCustomCaptureRadius ? Target->CustomCaptureRadius : DefaultCaptureRadius;
+}
+
+const FVector& FTargetSnapshot::GetActorLocation(int32 Index)
+{
+	if (!IsEvaluated(LocationStamps, Index))
+	{
+		const AActor* const Owner = Targets[Index]->GetOwner();
+		ActorLocations[Index] = Owner ? Owner->GetActorLocation() : FVector::ZeroVector;
+		LocationStamps[Index] = FrameStamp;
+	}
+
+	return ActorLocations[Index];
+}
+
+float FTargetSnapshot::GetLastRenderTime(int32 Index)
+{
+	if (!IsEvaluated(RenderTimeStamps, Index))
+	{
+		const AActor* const Owner = Targets[Index]->GetOwner();
+		LastRenderTimes[Index] = Owner ? Owner->GetLastRenderTime() : -1000.f;
+		RenderTimeStamps[Index] = FrameStamp;
+	}
+
+	return LastRenderTimes[Index];
+}
+
+const FSphere& FTargetSnapshot::GetBounds(int32 Index)
+{
+	if (!IsEvaluated(BoundsStamps, Index))
+	{
+		const USceneComponent* const AssociatedComponent = Targets[Index]->GetAssociatedComponent();
+		Bounds[Index] = AssociatedComponent ? AssociatedComponent->Bounds.GetSphere() : FSphere(GetActorLocation(Index), 0.f);
+		BoundsStamps[Index] = FrameStamp;
+	}
+
+	return Bounds[Index];
+}
+
+TArrayView<const FVector> FTargetSnapshot::GetSocketLocations(int32 Index)
+{
+	if (!IsEvaluated(SocketStamps, Index))
+	{
+		EvaluateSockets(Index);
+	}
+
+	return MakeArrayView(SocketLocations.GetData() + SocketStarts[Index], SocketNums[Index]);
+}
+
+FVector FTargetSnapshot::GetSocketLocation(int32 Index, FName Socket)
+{
+	const int32 SocketIndex = GetSockets(Index).Find(Socket);
+
+	if (SocketIndex == INDEX_NONE)
+	{
+		//The Socket has been added after the snapshot was built.
+		return Targets[Index]->GetSocketLocation(Socket);
+	}
+
+	return GetSocketLocations(Index)[SocketIndex];
+}
+
+void FTargetSnapshot::EvaluateSockets(int32 Index)
+{
+	const UTargetComponent* const Target = Targets[Index];
+	const TArray<FName>& TargetSockets = Target->GetSockets();
+	const int32 Start = SocketStarts[Index];
+	const int32 End = Start + SocketNums[Index];
+
+	//The Target per-frame cache is shared if enabled. Sockets may have changed since the snapshot was built.
+	for (int32 i = Start; i < End; ++i)
+	{
+		const int32 SocketIndex = i - Start;
+		const bool bSameSocket = TargetSockets.IsValidIndex(SocketIndex) && TargetSockets[SocketIndex] == SocketNames[i];
+		SocketLocations[i] = bSameSocket ? Target->GetSocketLocationByIndex(SocketIndex) : Target->GetSocketLocation(SocketNames[i]);
+	}
+
+	SocketStamps[Index] = FrameStamp;
+}
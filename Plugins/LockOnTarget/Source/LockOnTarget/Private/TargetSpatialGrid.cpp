@@ -0,0 +1,233 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "TargetSpatialGrid.h"
+#include "TargetComponent.h"
+#include "LockOnTargetDefines.h"
+
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+
+FTargetSpatialGrid::FTargetSpatialGrid(float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 100.f))
+	, InvCellSize(1.f / CellSize)
+{
+	//Do something.
+}
+
+void FTargetSpatialGrid::Add(UTargetComponent* Target)
+{
+	check(Target);
+
+	if (TargetCells.Contains(Target))
+	{
+		return;
+	}
+
+	FCellItem Item;
+	Item.Target = Target;
+	Item.Channels = Target->GetTargetingChannels();
+	ReadItem(Item);
+
+	const USceneComponent* const RootComponent = Target->GetOwner() ? Target->GetOwner()->GetRootComponent() : nullptr;
+
+	FTargetCellInfo& CellInfo = TargetCells.Add(Target);
+	CellInfo.Cell = GetCell(Item.Location);
+	CellInfo.bStatic = RootComponent && RootComponent->Mobility == EComponentMobility::Static;
+
+	AddItem(CellInfo, Item);
+}
+
+void FTargetSpatialGrid::Remove(UTargetComponent* Target)
+{
+	FTargetCellInfo CellInfo;
+
+	if (TargetCells.RemoveAndCopyValue(Target, CellInfo))
+	{
+		RemoveItem(CellInfo);
+	}
+}
+
+bool FTargetSpatialGrid::Update(UTargetComponent* Target)
+{
+	FTargetCellInfo* const CellInfo = TargetCells.Find(Target);
+
+	if (!CellInfo)
+	{
+		return false;
+	}
+
+	if (CellInfo->bStatic)
+	{
+		return true;
+	}
+
+	TArray<FCellItem>& CellItems = Cells.FindChecked(CellInfo->Cell);
+	check(CellItems.IsValidIndex(CellInfo->ItemIndex) && CellItems[CellInfo->ItemIndex].Target == Target);
+
+	FCellItem& Item = CellItems[CellInfo->ItemIndex];
+	ReadItem(Item);
+
+	const FIntPoint NewCell = GetCell(Item.Location);
+
+	//Only move the Target if it has left the cell.
+	if (NewCell != CellInfo->Cell)
+	{
+		const FCellItem MovedItem = Item;
+		RemoveItem(*CellInfo);
+		CellInfo->Cell = NewCell;
+		AddItem(*CellInfo, MovedItem);
+	}
+
+	return true;
+}
+
+void FTargetSpatialGrid::AddItem(FTargetCellInfo& CellInfo, const FCellItem& Item)
+{
+	CellInfo.ItemIndex = Cells.FindOrAdd(CellInfo.Cell).Add(Item);
+}
+
+void FTargetSpatialGrid::RemoveItem(const FTargetCellInfo& CellInfo)
+{
+	TArray<FCellItem>* const CellItems = Cells.Find(CellInfo.Cell);
+
+	if (!CellItems || !CellItems->IsValidIndex(CellInfo.ItemIndex))
+	{
+		return;
+	}
+
+	CellItems->RemoveAtSwap(CellInfo.ItemIndex, 1, false);
+
+	//Fix up the index of the item swapped into the freed place.
+	if (CellItems->IsValidIndex(CellInfo.ItemIndex))
+	{
+		TargetCells.FindChecked((*CellItems)[CellInfo.ItemIndex].Target).ItemIndex = CellInfo.ItemIndex;
+	}
+	else if (CellItems->IsEmpty())
+	{
+		Cells.Remove(CellInfo.Cell);
+	}
+}
+
+void FTargetSpatialGrid::Reset()
+{
+	Cells.Reset();
+	TargetCells.Reset();
+}
+
+void FTargetSpatialGrid::Query(const FVector& Origin, float Radius, const FVector& ConeDirection, float ConeHalfAngle, TArray<UTargetComponent*>& OutTargets, uint8 ChannelMask) const
+{
+	LOT_SCOPED_EVENT(SpatialGrid_Query);
+
+	const float QueryRadius = Radius + QuerySlack;
+	const float QueryRadiusSq = FMath::Square(QueryRadius);
+	const float ConeHalfAngleRad = FMath::DegreesToRadians(ConeHalfAngle);
+
+	const FIntPoint MinCell = GetCell(Origin - FVector(QueryRadius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(QueryRadius));
+	const int64 NumCellsInRange = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1);
+
+	auto GatherCell = [&](const TArray<FCellItem>& CellItems)
+		{
+			for (const FCellItem& Item : CellItems)
+			{
+				//Targets in other channels are skipped before any math.
+				if ((Item.Channels & ChannelMask) && IsItemInVolume(Item, Origin, QueryRadiusSq, ConeDirection, ConeHalfAngleRad))
+				{
+					OutTargets.Add(Item.Target);
+				}
+			}
+		};
+
+	//Iterate over the populated cells directly if it's cheaper, e.g. for a huge radius.
+	if (NumCellsInRange > Cells.Num())
+	{
+		for (const TPair<FIntPoint, TArray<FCellItem>>& Cell : Cells)
+		{
+			if (Cell.Key.X >= MinCell.X && Cell.Key.X <= MaxCell.X && Cell.Key.Y >= MinCell.Y && Cell.Key.Y <= MaxCell.Y)
+			{
+				GatherCell(Cell.Value);
+			}
+		}
+	}
+	else
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				if (const TArray<FCellItem>* const CellItems = Cells.Find(FIntPoint(X, Y)))
+				{
+					GatherCell(*CellItems);
+				}
+			}
+		}
+	}
+}
+
+FIntPoint FTargetSpatialGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X * InvCellSize), FMath::FloorToInt32(Location.Y * InvCellSize));
+}
+
+void FTargetSpatialGrid::ReadItem(FCellItem& Item) const
+{
+	const AActor* const Owner = Item.Target ? Item.Target->GetOwner() : nullptr;
+
+	if (!Owner)
+	{
+		return;
+	}
+
+	Item.Location = Owner->GetActorLocation();
+
+	if (const USceneComponent* const AssociatedComponent = Item.Target->GetAssociatedComponent())
+	{
+		Item.BoundsOrigin = AssociatedComponent->Bounds.Origin;
+		float MaxSocketDistanceSq = FMath::Square(AssociatedComponent->Bounds.SphereRadius);
+
+		//Sockets aren't necessarily inside the bounds, e.g. a FocusPoint socket above the head.
+		for (const FName& Socket : Item.Target->GetSockets())
+		{
+			MaxSocketDistanceSq = FMath::Max(MaxSocketDistanceSq, FVector::DistSquared(AssociatedComponent->GetSocketLocation(Socket), Item.BoundsOrigin));
+		}
+
+		Item.BoundsRadius = FMath::Sqrt(MaxSocketDistanceSq);
+	}
+	else
+	{
+		Item.BoundsOrigin = Item.Location;
+		Item.BoundsRadius = 0.f;
+	}
+}
+
+bool FTargetSpatialGrid::IsItemInVolume(const FCellItem& Item, const FVector& Origin, float RadiusSq, const FVector& ConeDirection, float ConeHalfAngleRad) const
+{
+	if ((Item.Location - Origin).SizeSquared() > RadiusSq)
+	{
+		return false;
+	}
+
+	if (ConeHalfAngleRad >= UE_PI)
+	{
+		return true;
+	}
+
+	//Bounding sphere vs cone.
+	const FVector Delta = Item.BoundsOrigin - Origin;
+	const float Distance = Delta.Size();
+	const float SphereRadius = Item.BoundsRadius + QuerySlack;
+
+	if (Distance <= SphereRadius)
+	{
+		return true;
+	}
+
+	const float ExpandedAngle = ConeHalfAngleRad + FMath::Asin(SphereRadius / Distance);
+
+	if (ExpandedAngle >= UE_PI)
+	{
+		return true;
+	}
+
+	return (Delta | ConeDirection) >= Distance * FMath::Cos(ExpandedAngle);
+}
@@ -0,0 +1,131 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "ExtensionTickManager.generated.h"
+
+class ULockOnTargetExtensionProxy;
+class UWorld;
+
+/**
+ * Tick function that calls ULockOnTargetExtensionProxy::Update() for all enabled extensions of the same class and tick settings.
+ * Each extension keeps its own tick interval. ExtensionTick.TickInterval.
+ */
+USTRUCT()
+struct LOCKONTARGET_API FLockOnTargetExtensionBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+
+	//Class of the updated extensions.
+	UClass* ExtensionClass = nullptr;
+
+	//Enabled extensions. Disabled ones are swapped out.
+	TArray<ULockOnTargetExtensionProxy*> Extensions;
+
+	//Time accumulated since the last update of each extension. In the same order as Extensions.
+	TArray<float> AccumulatedTimes;
+
+	//Extensions removed during the tick are nulled and compacted afterwards.
+	bool bIsExecuting = false;
+	bool bHasRemovedExtensions = false;
+
+public:
+
+	void AddExtension(ULockOnTargetExtensionProxy* Extension);
+	void RemoveExtension(ULockOnTargetExtensionProxy* Extension);
+
+private:
+
+	void RemoveExtensionAt(int32 Index);
+	void CompactExtensions();
+
+public: //Overrides
+
+	//FTickFunction
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FLockOnTargetExtensionBatchTickFunction> : public TStructOpsTypeTraitsBase2<FLockOnTargetExtensionBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Runs the extensions that opted in bUseBatchedTick in a single tick function per extension class and tick settings (including the tick group),
+ * instead of a tick function per extension. Reduces the scheduling overhead with many instigators, e.g. lots of AI.
+ *
+ * Only extensions without tick prerequisites are batched. A batch shared by many actors would make all of them wait for
+ * the prerequisites of each one, so extensions with prerequisites keep their own tick function and the ordering stays per actor.
+ * Dependents should be added via ULockOnTargetExtensionProxy::AddUpdateDependent().
+ */
+UCLASS()
+class LOCKONTARGET_API UExtensionTickManager final : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UExtensionTickManager();
+	static UExtensionTickManager& Get(UWorld& InWorld);
+
+private: /** Internal */
+
+	struct FBatchKey
+	{
+		const UClass* ExtensionClass = nullptr;
+		ETickingGroup TickGroup = TG_PrePhysics;
+		ETickingGroup EndTickGroup = TG_PrePhysics;
+		bool bTickEvenWhenPaused = false;
+		bool bAllowTickOnDedicatedServer = false;
+		bool bHighPriority = false;
+
+		friend bool operator==(const FBatchKey& lhs, const FBatchKey& rhs)
+		{
+			return lhs.ExtensionClass == rhs.ExtensionClass && lhs.TickGroup == rhs.TickGroup && lhs.EndTickGroup == rhs.EndTickGroup
+				&& lhs.bTickEvenWhenPaused == rhs.bTickEvenWhenPaused && lhs.bAllowTickOnDedicatedServer == rhs.bAllowTickOnDedicatedServer && lhs.bHighPriority == rhs.bHighPriority;
+		}
+
+		friend uint32 GetTypeHash(const FBatchKey& Key)
+		{
+			const uint32 Flags = Key.TickGroup | (Key.EndTickGroup << 8) | (Key.bTickEvenWhenPaused << 16) | (Key.bAllowTickOnDedicatedServer << 17) | (Key.bHighPriority << 18);
+			return HashCombineFast(PointerHash(Key.ExtensionClass), Flags);
+		}
+	};
+
+	//Batched tick functions. Allocated separately as registered tick functions must not be moved.
+	TMap<FBatchKey, TUniquePtr<FLockOnTargetExtensionBatchTickFunction>> Batches;
+
+	//Extensions referencing the batches. Their references are cleared once the batches are destroyed.
+	TSet<ULockOnTargetExtensionProxy*> RegisteredExtensions;
+
+public:
+
+	/** Whether the extension can be batched, i.e. its tick function has no prerequisites. */
+	static bool CanBatchExtension(const ULockOnTargetExtensionProxy* Extension);
+
+	/** Finds or creates the batched tick function of the extension and assigns it to the extension. The extension isn't enabled. */
+	void RegisterExtension(ULockOnTargetExtensionProxy* Extension);
+
+	/** Removes the extension from its batched tick function and clears the reference to it. */
+	void UnregisterExtension(ULockOnTargetExtensionProxy* Extension);
+
+	/** Returns the number of the batched tick functions. */
+	int32 GetBatchesNum() const { return Batches.Num(); }
+
+protected: /** Overrides */
+
+	//UWorldSubsystem
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
@@ -0,0 +1,75 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FindTargetScheduler.generated.h"
+
+class UWorld;
+
+/**
+ * Spreads deferred FindTarget requests across frames within a time budget.
+ * Used for non-player-controlled instigators, so that many of them retargeting at once (e.g. when a shared Target dies) don't spike a single frame.
+ * Player requests should never be scheduled and are expected to be performed immediately.
+ *
+ * Requests processed in the same frame share the TargetManager snapshot, so the data of each queried Target is evaluated once for all of them.
+ * Candidates themselves aren't shared, as each instigator gathers them around its own view.
+ * Only one request per owner is kept. The newest one replaces the pending one, keeping its place in the queue.
+ */
+UCLASS(Config = Game)
+class LOCKONTARGET_API UFindTargetScheduler final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	UFindTargetScheduler();
+	static UFindTargetScheduler& Get(UWorld& InWorld);
+
+private: /** Config */
+
+	/** Time budget per frame in microseconds. At least one request is processed each frame. */
+	UPROPERTY(Config)
+	float FrameBudget;
+
+private: /** Internal */
+
+	struct FScheduledRequest
+	{
+		TWeakObjectPtr<const UObject> Owner;
+		FSimpleDelegate Request;
+	};
+
+	//Pending requests in the order of arrival. Processed and cancelled requests are unbound during the tick and compacted once afterwards.
+	TArray<FScheduledRequest> PendingRequests;
+	bool bIsProcessingRequests = false;
+
+public:
+
+	//Schedules the request. Replaces the pending request of the same owner.
+	void ScheduleRequest(const UObject* Owner, FSimpleDelegate&& Request);
+
+	//Removes the pending request of the owner.
+	void CancelRequest(const UObject* Owner);
+
+	bool HasPendingRequest(const UObject* Owner) const;
+	int32 GetPendingRequestsNum() const { return PendingRequests.Num(); }
+
+	//Updates the time budget per frame in microseconds.
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget FindTarget Scheduler")
+	void SetFrameBudget(float InFrameBudget) { FrameBudget = FMath::Max(InFrameBudget, 0.f); }
+
+	UFUNCTION(BlueprintPure, Category = "LockOnTarget FindTarget Scheduler")
+	float GetFrameBudget() const { return FrameBudget; }
+
+protected: /** Overrides */
+
+	//UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//UWorldSubsystem
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
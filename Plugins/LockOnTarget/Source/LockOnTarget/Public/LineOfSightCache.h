@@ -0,0 +1,122 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "LockOnTargetTypes.h"
+
+class UTargetComponent;
+class AActor;
+
+/**
+ * A line of sight query from a view location to the Target Socket.
+ */
+struct FLineOfSightQuery
+{
+	const UTargetComponent* Target = nullptr;
+	FName Socket = NAME_None;
+	ECollisionChannel Channel = ECC_Visibility;
+
+	//Actor ignored by the trace besides the Target owner, e.g. the instigator pawn. Isn't a part of the key. Only compared.
+	const AActor* IgnoredActor = nullptr;
+
+	//Set instead of the Target for a lightweight Target without a component. UTargetManager::RegisterLightweightTarget().
+	FTargetHandle LightweightTarget;
+
+	FVector ViewLocation = FVector::ZeroVector;
+	FVector TargetLocation = FVector::ZeroVector;
+};
+
+/**
+ * Short-lived cache of line of sight results shared by all instigators.
+ * Results are keyed by the Target (or the lightweight Target handle), Socket, channel and a quantized view location.
+ * Each trace ignores its instigator, so an occluded result is discarded if it has been blocked by the actor the query ignores.
+ * A visible result is reused as is, i.e. the pawn of the instigator that has traced it isn't treated as a blocker.
+ *
+ * A result is reused if it isn't older than the max age and neither the viewer nor the Target has moved beyond the tolerance.
+ */
+class LOCKONTARGET_API FLineOfSightCache
+{
+public:
+
+	/** Size of the cell used to quantize view locations. */
+	static constexpr float ViewCellSize = 50.f;
+
+	/** Entries older than this are removed. */
+	static constexpr float MaxEntryAge = 1.f;
+
+public:
+
+	/** Finds a valid result. Returns false if there is none. */
+	bool Find(const FLineOfSightQuery& Query, float Time, float MaxAge, float Tolerance, bool& bOutVisible) const;
+
+	/**
+	 * Stores the result.
+	 * @param BlockingActor - Actor that has blocked the trace if occluded.
+	 */
+	void Store(const FLineOfSightQuery& Query, float Time, bool bVisible, const AActor* BlockingActor = nullptr);
+
+	/** Removes all results of the Target. */
+	void RemoveTarget(const UTargetComponent* Target);
+
+	/** Removes all results. */
+	void Reset();
+
+	int32 Num() const;
+
+private:
+
+	//Results are grouped by the Target, so all of them are removed at once.
+	struct FTargetKey
+	{
+		const UTargetComponent* Target = nullptr;
+		FTargetHandle LightweightTarget;
+
+		friend bool operator==(const FTargetKey& lhs, const FTargetKey& rhs)
+		{
+			return lhs.Target == rhs.Target && lhs.LightweightTarget == rhs.LightweightTarget;
+		}
+
+		friend uint32 GetTypeHash(const FTargetKey& Key)
+		{
+			return HashCombineFast(PointerHash(Key.Target), GetTypeHash(Key.LightweightTarget));
+		}
+	};
+
+	struct FKey
+	{
+		FName Socket = NAME_None;
+		FIntVector ViewCell = FIntVector::ZeroValue;
+		uint8 Channel = 0;
+
+		friend bool operator==(const FKey& lhs, const FKey& rhs)
+		{
+			return lhs.Socket == rhs.Socket && lhs.ViewCell == rhs.ViewCell && lhs.Channel == rhs.Channel;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			const uint32 Hash = HashCombineFast(GetTypeHash(Key.Socket), GetTypeHash(Key.ViewCell));
+			return HashCombineFast(Hash, Key.Channel);
+		}
+	};
+
+	struct FEntry
+	{
+		FVector ViewLocation = FVector::ZeroVector;
+		FVector TargetLocation = FVector::ZeroVector;
+
+		//Only compared.
+		const AActor* BlockingActor = nullptr;
+		float Time = 0.f;
+		bool bVisible = false;
+	};
+
+	static FTargetKey MakeTargetKey(const FLineOfSightQuery& Query);
+	static FKey MakeKey(const FLineOfSightQuery& Query);
+	void Prune(float Time);
+
+	TMap<FTargetKey, TMap<FKey, FEntry>> Entries;
+	float LastPruneTime = 0.f;
+};
@@ -50,6 +50,10 @@ private: /** Core Config */
 	/** Special extension that handles the Target. Get/SetTargetHandler(). */
 	UPROPERTY(Instanced, EditDefaultsOnly, Category = "Default Settings")
 	TObjectPtr<UTargetHandlerBase> TargetHandlerImplementation;
+
+	/** Whether FindTarget requests of non-player-controlled owners are spread across frames by the UFindTargetScheduler. Player requests are never deferred. */
+	UPROPERTY(EditAnywhere, Category = "Default Settings")
+	bool bScheduleFindTargetRequests;
 	
 	/** Set of customizable independent features. Add/RemoveExtensionByClass(). */
 	UPROPERTY(Instanced, EditDefaultsOnly, Category = "Extensions", meta = (DisplayName = "Default Extensions", NoResetToDefault))
@@ -80,6 +84,39 @@ public: /** Input Config */
 	/** Unfreeze the InputBuffer filling if the input is less than the threshold. */
 	UPROPERTY(EditDefaultsOnly, Category = "Player Input", meta = (ClampMin = 0.f, EditCondition = "bUseInputFreezing", EditConditionHides))
 	float UnfreezeThreshold;
+
+public: /** Significance Config */
+
+	/**
+	 * Whether to lower the update rate of the component, the TargetHandler and extensions for insignificant instigators, e.g. distant or off-screen AI.
+	 * Player-controlled instigators are always updated at the full rate. CalculateSignificance().
+	 * The configured tick intervals are restored once disabled.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, BlueprintSetter = SetUseSignificance, Category = "Significance")
+	bool bUseSignificance;
+
+	/** How often the significance is recalculated while the Target is locked. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Significance", meta = (EditCondition = "bUseSignificance", ClampMin = 0.f, Units = "s"))
+	float SignificanceUpdateInterval;
+
+	/**
+	 * Tick interval at the minimum significance. Scaled down linearly to 0 at the full significance.
+	 * The component and extensions are never updated more often than their own configured tick intervals.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Significance", meta = (EditCondition = "bUseSignificance", ClampMin = 0.f, Units = "s"))
+	float MaxSignificanceTickInterval;
+
+	/** The lowest significance. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Significance", meta = (EditCondition = "bUseSignificance", ClampMin = 0.01f, ClampMax = 1.f))
+	float MinSignificance;
+
+	/** Distance to the closest player view within which the significance falls from full to the minimum. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Significance", meta = (EditCondition = "bUseSignificance"))
+	FVector2D SignificanceDistanceRange;
+
+	/** Significance multiplier if the owner hasn't been rendered recently. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Significance", meta = (EditCondition = "bUseSignificance", ClampMin = 0.f, ClampMax = 1.f))
+	float OffScreenSignificanceScale;
 	
 public: /** Callbacks */
 
@@ -112,6 +149,13 @@ private: /** Internal */
 	//Is any Target captured.
 	bool bIsTargetLocked;
 
+	//Current significance in the [MinSignificance, 1] range.
+	float Significance;
+	float SignificanceUpdateTimer;
+
+	//Configured tick interval at the full significance.
+	float BaseTickInterval;
+
 protected: /** Input Internal */
 
 	bool bInputFrozen;
@@ -203,6 +247,43 @@ protected: /** Target Handling */
 	//Only the locally controlled Owner can control the Target.
 	bool HasAuthorityOverTarget() const;
 
+	//Performs RequestFindTarget() if the Target can still be captured. Called by the UFindTargetScheduler.
+	void PerformScheduledFindTarget(const FFindTargetRequestParams& RequestParams);
+
+public: /** Scheduling */
+
+	//Whether FindTarget requests should be deferred to the UFindTargetScheduler.
+	bool ShouldScheduleFindTarget() const;
+
+	//Whether the Owner is controlled by a player.
+	bool IsOwnerPlayerControlled() const;
+
+public: /** Significance */
+
+	/** Returns the current significance. 1 - full update rate. */
+	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Significance")
+	float GetSignificance() const { return Significance; }
+
+	/** Returns the additional tick interval derived from the significance. 0 at the full significance. */
+	float GetSignificanceTickInterval() const;
+
+	/** Calculates the significance of the instigator. Isn't called for player-controlled instigators. */
+	UFUNCTION(BlueprintNativeEvent, Category = "LockOnTargetComponent|Significance")
+	float CalculateSignificance() const;
+	virtual float CalculateSignificance_Implementation() const;
+
+	/** Recalculates the significance and updates the rates. */
+	UFUNCTION(BlueprintCallable, Category = "LockOnTargetComponent|Significance")
+	void UpdateSignificance();
+
+	/** Enables or disables the significance. Disabling restores the configured tick intervals of the component and extensions. */
+	UFUNCTION(BlueprintCallable, BlueprintSetter, Category = "LockOnTargetComponent|Significance")
+	void SetUseSignificance(bool bInUseSignificance);
+
+private:
+
+	void SetSignificance(float InSignificance);
+
 public: /** Target Validation */
 
 	//Can the Target be captured.
@@ -211,6 +292,10 @@ public: /** Target Validation */
 	//Whether the target meets all the requirements for being captured.
 	bool IsTargetValid(const UTargetComponent* Target) const;
 
+	//Returns the Target to capture from the TargetHandler response, promoting the lightweight Target to an actor if the response has one.
+	//The promotion spawns the actor and registers a regular Target, so it should only be called right before the capture.
+	FTargetInfo PromoteTargetHandlerResponse(const FFindTargetRequestResponse& Response);
+
 protected: /** Target Synchronization */
 
 	//Updates the CurrentTargetInternal locally and sends it to the server.
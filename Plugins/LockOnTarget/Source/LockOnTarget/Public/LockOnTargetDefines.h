@@ -12,6 +12,9 @@ DECLARE_LOG_CATEGORY_EXTERN(LogLockOnTarget, All, All);
 #define LOG_WARNING(Str, ...) UE_LOG(LogLockOnTarget, Warning, TEXT("%s[%d]: " Str), *FString(__FUNCTION__), __LINE__, ##__VA_ARGS__)
 #define LOG_ERROR(Str, ...) UE_LOG(LogLockOnTarget, Error, TEXT("%s[%d]: " Str), *FString(__FUNCTION__), __LINE__, ##__VA_ARGS__)
 
+//Calls the native implementation of a BlueprintNativeEvent directly, skipping the Blueprint thunk, unless it's overridden in Blueprint.
+#define LOT_NATIVE_EVENT(bIsOverriddenInBlueprint, Event, ...) ((bIsOverriddenInBlueprint) ? Event(__VA_ARGS__) : Event##_Implementation(__VA_ARGS__))
+
 #if CPUPROFILERTRACE_ENABLED
 
 //Custom channel declaration. -trace=default,LockOnTarget
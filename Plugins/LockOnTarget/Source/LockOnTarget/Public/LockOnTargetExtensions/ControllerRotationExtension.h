@@ -96,6 +96,11 @@ private:
 	FVector SpringVelocity;
 	TOptional<FVector> SpringLocation;
 
+	//Blueprint overrides of the native events. Not overridden events are called via _Implementation.
+	uint8 bIsCalcRotationOverridden : 1;
+	uint8 bIsGetTargetFocusLocationOverridden : 1;
+	uint8 bIsGetViewLocationOverridden : 1;
+
 public:
 
 	/** Resets all cached spring data. */
@@ -11,6 +11,7 @@ class ULockOnTargetComponent;
 class UTargetComponent;
 class ULockOnTargetExtensionProxy;
 class ULockOnTargetExtensionBase;
+struct FLockOnTargetExtensionBatchTickFunction;
 class AController;
 class APlayerController;
 class APawn;
@@ -63,11 +64,28 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category="Tick")
 	FLockOnTargetExtensionTickFunction ExtensionTick;
 
+	/**
+	 * Whether to be updated by a single tick function shared by all extensions of the same class and tick settings. UExtensionTickManager.
+	 * Reduces the scheduling overhead with many instigators. ExtensionTick settings and interval are still respected.
+	 * Ignored if ExtensionTick has prerequisites on initialization, so that the extension doesn't delay or wait for other actors.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="Tick")
+	bool bUseBatchedTick;
+
 private: /** Internal */
 
 	ULockOnTargetComponent* LockOnTargetComponent;
 	uint8 bIsInitialized : 1;
 
+	//Batched tick function that updates the extension. bUseBatchedTick.
+	FLockOnTargetExtensionBatchTickFunction* BatchTick;
+	int32 BatchTickIndex;
+
+	//Tick interval at the full significance.
+	float BaseTickInterval;
+	friend struct FLockOnTargetExtensionBatchTickFunction;
+	friend class UExtensionTickManager;
+
 public: /** Polls */
 
 	/** Has the extension been successfully initialized. */
@@ -94,12 +112,19 @@ public: /** Tick */
 
 	/** Whether the tick is enabled. */
 	UFUNCTION(BlueprintPure, Category="LockOnTargetExtension|Tick")
-	bool IsTickEnabled() const { return ExtensionTick.IsTickFunctionEnabled(); }
+	bool IsTickEnabled() const { return BatchTick ? BatchTickIndex != INDEX_NONE : ExtensionTick.IsTickFunctionEnabled(); }
 
 	/** Set the new tick state. */
 	UFUNCTION(BlueprintCallable, Category="LockOnTargetExtension|Tick")
 	void SetTickEnabled(bool bInTickEnabled);
 
+	/** Returns the tick function that updates the extension. Either the ExtensionTick or the batched one. */
+	FTickFunction& GetUpdateTickFunction();
+
+	/** Makes the dependent tick function wait for the extension update. Should be used instead of adding ExtensionTick as a prerequisite directly. */
+	void AddUpdateDependent(FTickFunction& Dependent);
+	void RemoveUpdateDependent(FTickFunction& Dependent);
+
 public: /** Extension Interface */
 
 	//Extension lifetime.
@@ -113,6 +138,14 @@ public: /** Extension Interface */
 	virtual void OnSocketChanged(UTargetComponent* CurrentTarget, FName NewSocket, FName OldSocket);
 	virtual void OnTargetNotFound(bool bIsTargetLocked);
 
+	//Called when the significance of the owning LockOnTargetComponent has changed. Scales the tick interval by default.
+	virtual void OnSignificanceChanged(float Significance);
+
+protected: /** Native Events */
+
+	//Whether the BlueprintNativeEvent is overridden in a Blueprint subclass. Should be evaluated once in Initialize(). LOT_NATIVE_EVENT().
+	bool IsEventOverriddenInBlueprint(FName EventName) const { return GetClass()->IsFunctionImplementedInScript(EventName); }
+
 public: /** Overrides */
 
 	//UObject.
@@ -32,6 +32,10 @@ public: /** Config */
 	UPROPERTY(EditDefaultsOnly, Category="Target Preview", meta = (ClampMin = 0.f, ClampMax = 1.f, Units = "s"))
 	float UpdateRate;
 
+	/** Whether to reuse the candidates between updates. Only the changed ones are re-evaluated. UTargetHandlerBase::FindTargetIncremental(). */
+	UPROPERTY(EditDefaultsOnly, Category = "Target Preview")
+	bool bUseIncrementalUpdate;
+
 private: /** Internal */
 
 	//Current preview Target.
@@ -86,6 +86,47 @@ enum class ETargetExceptionType : uint8
 	SocketInvalidation	UMETA(ToolTip="Target has deleted a Socket.")
 };
 
+/**
+ * Stable handle of a Target registered in UTargetManager.
+ * The generation is bumped when the slot is released, so a dangling handle is detected without touching the Target.
+ */
+struct FTargetHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsSet() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Generation = 0; }
+
+	friend bool operator==(const FTargetHandle& lhs, const FTargetHandle& rhs) { return lhs.Index == rhs.Index && lhs.Generation == rhs.Generation; }
+	friend bool operator!=(const FTargetHandle& lhs, const FTargetHandle& rhs) { return !(lhs == rhs); }
+	friend uint32 GetTypeHash(const FTargetHandle& Handle) { return HashCombineFast(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation)); }
+};
+
+/**
+ * Targeting channels. Targets declare the channels they belong to and instigators declare the channels they can target.
+ * Registered Targets are partitioned by channels, so instigators only iterate the relevant ones.
+ */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ETargetingChannel : uint8
+{
+	None		= 0 UMETA(Hidden),
+
+	Default		= 1 << 0,
+	Channel1	= 1 << 1,
+	Channel2	= 1 << 2,
+	Channel3	= 1 << 3,
+	Channel4	= 1 << 4,
+	Channel5	= 1 << 5,
+	Channel6	= 1 << 6,
+	Channel7	= 1 << 7,
+
+	All			= 0b11111111 UMETA(Hidden)
+};
+
+//Number of the targeting channels.
+constexpr int32 NumTargetingChannels = 8;
+
 //Finds a component within an Actor by name. If not found or Name == None, then nulltpr will be returned.
 template<typename T>
 typename TEnableIf<TPointerIsConvertibleFromTo<T, const class UActorComponent>::Value, T>::Type* FindComponentByName(const AActor* Actor, FName Name)
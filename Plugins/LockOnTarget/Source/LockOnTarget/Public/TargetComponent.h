@@ -64,9 +64,16 @@ private: /** General */
 	UPROPERTY(EditAnywhere, Category = "General", meta = (EditFixedOrder, DisplayName = "Sockets Data", NoResetToDefault))
 	TArray<FName> Sockets;
 
+	/** Targeting channels the Target belongs to. Only instigators targeting any of them can capture the Target. SetTargetingChannels(). */
+	UPROPERTY(EditAnywhere, Category = "General", meta = (Bitmask, BitmaskEnum = "/Script/LockOnTarget.ETargetingChannel"))
+	uint8 TargetingChannels;
+
 public: /** General */
 
-	/** Whether to use the default capture radius or custom. */
+	/**
+	 * Whether to use the default capture radius or custom.
+	 * @note Call UTargetManager::RefreshTarget() if changed at runtime.
+	 */
 	UPROPERTY(EditAnywhere, Category = "General", meta = (InlineEditConditionToggle))
 	bool bForceCustomCaptureRadius;
 
@@ -78,6 +85,14 @@ public: /** General */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "General", meta = (ClampMin = 0.f, ClampMax = 1.f, Units = "x"))
 	float Priority;
 
+	/**
+	 * Whether to cache the Socket and FocusPoint world locations once per frame.
+	 * Useful if the Target is queried many times per frame, e.g. by several extensions of the locked instigator.
+	 * @note Locations are evaluated on the first access in the frame, so a later movement within the frame isn't reflected.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "General")
+	bool bCacheSocketLocations;
+
 public: /** Focus Point */
 
 	/** Specifies the FocusPoint type. */
@@ -124,6 +139,28 @@ private:
 	//The component used for Socket lookup, attachment and etc.
 	TWeakObjectPtr<USceneComponent> AssociatedComponent;
 
+	//Per-frame cache of the Socket locations in the same order as Sockets. bCacheSocketLocations.
+	mutable TArray<FVector> CachedSocketLocations;
+	mutable TArray<uint64> CachedSocketFrames;
+
+	//Index of the last requested Socket. Checked before the lookup.
+	mutable int32 LastSocketIndex;
+
+	//Per-frame cache of the last requested FocusPoint location (without the offset).
+	//Keyed on the frame, instigator, FocusPoint type and the resolved Socket.
+	mutable FVector CachedFocusPointLocation;
+	mutable uint64 CachedFocusPointFrame;
+	mutable const ULockOnTargetComponent* CachedFocusPointInstigator;
+	mutable ETargetFocusPointType CachedFocusPointType;
+	mutable FName CachedFocusPointSocket;
+
+	//Whether GetCustomFocusPoint() is overridden in Blueprint. Otherwise it's called via _Implementation.
+	bool bIsGetCustomFocusPointOverridden;
+
+	//Handle assigned by the TargetManager on registration.
+	FTargetHandle TargetHandle;
+	friend class UTargetManager;
+
 public: /** Target State */
 
 	/** Can the Target be captured by ULockOnTargetComponent. */
@@ -148,6 +185,24 @@ public: /** Target State */
 	UFUNCTION(BlueprintPure, Category = "Target")
 	int32 GetInvadersNum() const { return Invaders.Num(); }
 
+public: /** Registration */
+
+	/** Returns the handle assigned by the TargetManager. Not set if the Target isn't registered. */
+	const FTargetHandle& GetTargetHandle() const { return TargetHandle; }
+
+public: /** Targeting Channels */
+
+	/** Returns the targeting channels the Target belongs to. */
+	UFUNCTION(BlueprintPure, Category = "Target")
+	uint8 GetTargetingChannels() const { return TargetingChannels; }
+
+	/** Updates the targeting channels the Target belongs to. */
+	UFUNCTION(BlueprintCallable, Category = "Target")
+	void SetTargetingChannels(UPARAM(meta = (Bitmask, BitmaskEnum = "/Script/LockOnTarget.ETargetingChannel")) uint8 InTargetingChannels);
+
+	/** Whether the Target belongs to any of the channels. */
+	bool IsInTargetingChannels(uint8 ChannelMask) const { return (TargetingChannels & ChannelMask) != 0; }
+
 public: /** Associated Component */
 
 	/** Returns the associated component. */
@@ -175,6 +230,12 @@ public: /** Sockets */
 	UFUNCTION(BlueprintPure, Category = "Target")
 	FVector GetSocketLocation(FName Socket) const;
 
+	/** Returns the world location of the Socket by its index in GetSockets(). */
+	FVector GetSocketLocationByIndex(int32 SocketIndex) const;
+
+	/** Returns the index of the Socket in GetSockets() or INDEX_NONE. */
+	int32 FindSocketIndex(FName Socket) const;
+
 	/** Updates the default Socket in 0 index. */
 	UFUNCTION(BlueprintCallable, Category = "Target", meta = (AutoCreateRefTerm = "Socket"))
 	void SetDefaultSocket(FName Socket = NAME_None);
@@ -191,6 +252,17 @@ public: /** Sockets */
 	UFUNCTION(BlueprintCallable, Category = "Target", meta = (AutoCreateRefTerm = "Socket"))
 	bool RemoveSocket(FName Socket = NAME_None);
 
+private:
+
+	//Invalidates the cached Sockets data.
+	void NotifySocketsChanged();
+
+	//Evaluates the world location of the Socket bypassing the cache.
+	FVector EvaluateSocketLocation(FName Socket) const;
+
+	//Invalidates the per-frame cache of the Socket and FocusPoint locations.
+	void ResetSocketLocationsCache();
+
 public: /** Focus Point */
 
 	/** Returns the 'focus point' location for ULockOnTargetComponent. Mostly used by tracking systems. */
@@ -46,8 +46,17 @@ public:
 	/** An optional payload object passed along with the response. May be useful for custom implementations. */
 	UPROPERTY(BlueprintReadWrite, Category = "Request Params")
 	TObjectPtr<UObject> Payload = nullptr;
+
+	/**
+	 * Lightweight Target found instead of the regular one, in which case the Target is NULL_TARGET. UTargetManager::RegisterLightweightTarget().
+	 * Promoted to an actor only when the response is used to capture the Target. ULockOnTargetComponent::PromoteTargetHandlerResponse().
+	 */
+	FTargetHandle LightweightTarget;
 };
 
+/** Completion callback of the FindTargetAsync() request. */
+DECLARE_DELEGATE_OneParam(FOnFindTargetRequestCompleted, const FFindTargetRequestResponse& /*Response*/);
+
 /**
  * Special abstract LockOnTargetExtension which is used to handle the Target.
  * Responsible for finding and maintaining the Target.
@@ -94,6 +103,42 @@ public: /** Target Handler Interface */
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget|Target Handler Base")
 	bool IsTargetValid(const UTargetComponent* Target) const;
 
+	/**
+	 * Finds a Target for a frequently updated preview, e.g. UTargetPreviewExtension.
+	 * Implementations may reuse the results of previous calls, so the response might slightly lag behind FindTarget().
+	 * Calls FindTarget() by default.
+	 */
+	virtual FFindTargetRequestResponse FindTargetIncremental(const FFindTargetRequestParams& RequestParams);
+
+	/**
+	 * Finds a Target and passes the response to the callback.
+	 * Implementations may complete the request in the next frame. Only the latest pending request is guaranteed to be completed.
+	 * Calls FindTarget() and completes immediately by default.
+	 */
+	virtual void FindTargetAsync(const FFindTargetRequestParams& RequestParams, FOnFindTargetRequestCompleted&& OnCompleted);
+
+	/** Native entry points of the Target Handler Interface. Skip the Blueprint thunk if the event isn't overridden in Blueprint. */
+	FFindTargetRequestResponse FindTargetNative(const FFindTargetRequestParams& RequestParams = FFindTargetRequestParams());
+	void CheckTargetStateNative(const FTargetInfo& Target, float DeltaTime);
+	void HandleTargetExceptionNative(const FTargetInfo& Target, ETargetExceptionType Exception);
+
+protected:
+
+	//Whether FindTarget() is overridden in Blueprint.
+	bool IsFindTargetOverridden() const { return bIsFindTargetOverridden; }
+
+private:
+
+	//Blueprint overrides of the Target Handler Interface.
+	uint8 bIsFindTargetOverridden : 1;
+	uint8 bIsCheckTargetStateOverridden : 1;
+	uint8 bIsHandleTargetExceptionOverridden : 1;
+
+protected: /** Overrides */
+
+	//ULockOnTargetExtensionProxy
+	virtual void Initialize(ULockOnTargetComponent* Instigator) override;
+
 private: /** Internal */
 
 	virtual FFindTargetRequestResponse FindTarget_Implementation(const FFindTargetRequestParams& RequestParams);
@@ -4,13 +4,21 @@
 
 #include "TargetHandlers/TargetHandlerBase.h"
 #include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "LineOfSightCache.h"
+#include "Tasks/Task.h"
 #include <type_traits>
 #include "WeightedTargetHandler.generated.h"
 
 struct FTargetInfo;
 struct FTargetContext;
 struct FFindTargetContext;
+struct FTargetSnapshot;
+struct FWeightedTargetSolverParams;
+struct FWeightedFindTargetTask;
+struct FWeightedSpeculativeLineOfSight;
 class UWeightedTargetHandler;
+class UWeightedTargetHandlerDetailedResponse;
 class UTargetComponent;
 class ULockOnTargetComponent;
 class APlayerController;
@@ -153,9 +161,47 @@ public: /** View Info */
 	//Axes storage.
 	FMatrix ViewRotationMatrix;
 
+	//Cosines of the angular limits. Cosines are compared instead of angles.
+	float CosViewConeAngle = -1.f;
+	float CosPlayerInputAngularRange = -1.f;
+
 	//View direction adjusted by ViewPitch/Yaw offsets.
 	UPROPERTY(BlueprintReadOnly, Category = "Find Target Context")
 	FVector SolverViewDirection = FVector::ForwardVector;
+
+public: /** Screen Info */
+
+	//Transforms locations relative to ViewLocation to the clip space. Valid if bHasScreenData is true.
+	FMatrix44f ScreenMatrix = FMatrix44f::Identity;
+
+	//Normalized device coordinates limits narrowed by ScreenOffset.
+	FVector2f ScreenLimits = FVector2f::UnitVector;
+
+	//Whether the screen data has been captured. Only for the local players if bScreenCapture is set.
+	bool bHasScreenData = false;
+
+	//Whether the Targets data has already been culled by the screen.
+	bool bScreenCullingPerformed = false;
+};
+
+/**
+ * A caller-owned detailed response filled by UWeightedTargetHandler::FindTargetDetailed().
+ * Reusing the same instance keeps the buffer capacity, so frequent detailed requests produce no garbage.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FWeightedDetailedResponseData
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The context used while finding the Target. */
+	UPROPERTY(BlueprintReadOnly, Category = "DetailedResponse")
+	FFindTargetContext Context;
+
+	/** All sampled Targets with weights in ascending order. */
+	UPROPERTY(BlueprintReadOnly, Category = "DetailedResponse")
+	TArray<FTargetContext> TargetsData;
 };
 
 /**
@@ -164,17 +210,23 @@ public: /** View Info */
  * Weights can be visualized via the custom Gameplay Debugger category.
  *
  * Target finding is performed in 4 main passes:
- * 1. PrimarySampling - quickly rejects all invalid Targets.
+ * 1. PrimarySampling - quickly rejects all invalid Targets. Sockets are expanded only for the best Targets scored by their bounds.
  * 2. Solver - calculates weights for remaining Targets.
- * 3. Sort - sorts remaining Targets by weight in ascending order.
+ * 3. Sort - orders remaining Targets by weight. A heap by default, a fully sorted list for the detailed response.
  * 4. SecondarySampling - finds the first Target that passes the remaining checks.
  * 
+ * Weights are calculated by a vectorized batch solver unless CalculateTargetWeight() is overridden.
+ * FindTargetAsync() can perform the first 3 passes on a worker thread. bAsyncFindTarget.
+ * FindTargetAsync() traces the best few candidates at once by async traces. SpeculativeLineOfSightCandidates.
+ * FindTargetIncremental() keeps the candidates between calls and re-samples only the changed ones. Used by the preview.
+ * Lightweight Targets are evaluated on each incremental call, so both paths return the same kind of response.
  * Override CalculateTargetWeight() to use custom weight calculation logic.
  * Override ShouldSkipTargetCustom() to add custom rejection logic.
  * 
  * Upon request, all targets with calculated weights can be stored in a detailed response.
  * To retrieve a detailed response, set FFindTargetRequestParams::bGenerateDetailedResponse to true.
  * Cast the payload object from the response to the UWeightedTargetHandlerDetailedResponse.
+ * Each detailed request creates a new payload object. Frequent callers should use FindTargetDetailed() with their own buffer instead.
  * 
  * To enable profiling through Unreal Insights, add the -trace=default,lockontarget channel.
  *
@@ -190,6 +242,16 @@ public:
 	UWeightedTargetHandler();
 	static_assert(std::is_same_v<std::underlying_type_t<ETargetUnlockReason>, uint8>, "UWeightedTargetHandler::AutoFindTargetFlags must be of the same type as the EUnlockReason underlying type.");
 
+	//TargetHandlerBase
+	virtual FFindTargetRequestResponse FindTargetIncremental(const FFindTargetRequestParams& RequestParams) override;
+	virtual void FindTargetAsync(const FFindTargetRequestParams& RequestParams, FOnFindTargetRequestCompleted&& OnCompleted) override;
+
+	/**
+	 * Same as the detailed FindTarget() request, but the detailed response is written into the caller-owned buffer instead of a new payload object.
+	 * The response has no payload. The buffer is left empty if no detailed response is generated, e.g. by the precomputed switch Target.
+	 */
+	FFindTargetRequestResponse FindTargetDetailed(FWeightedDetailedResponseData& OutDetailedResponse, FFindTargetRequestParams RequestParams = FFindTargetRequestParams());
+
 public: /** Auto Find */
 
 	/** Attempts to automatically find a new Target when a certain flag fails. */
@@ -232,6 +294,19 @@ public: /** Solver */
 	UPROPERTY(EditDefaultsOnly, Category = "Solver", meta = (ClampMin = 0.f, ClampMax = 1.f, Units = "x"))
 	float MinimumFactorThreshold;
 
+	/**
+	 * Targets are scored by their bounds first and Sockets are only expanded for this number of the best ones.
+	 * Bounds the solver cost by the number of Targets rather than Sockets. All Targets are expanded if <= 0.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Solver", meta = (ClampMin = 0))
+	int32 MaxExpandedTargets;
+
+public: /** Targeting Channels */
+
+	/** Targeting channels the instigator can target. Targets in other channels are never sampled. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Targeting Channels", meta = (Bitmask, BitmaskEnum = "/Script/LockOnTarget.ETargetingChannel"))
+	uint8 TargetableChannels;
+
 public: /** Distance */
 
 	/** Target must be within a certain distance range. */
@@ -257,6 +332,14 @@ public: /** Distance */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Distance", meta = (EditCondition = "bDistanceCheck", EditConditionHides, ClampMin = 0.f, Units = "x"))
 	float CaptureRadiusScale;
 
+	/**
+	 * Whether the TargetManager should detect the captured Target leaving the lost radius instead of checking it every frame.
+	 * The check is rescheduled from the separation margin and the velocities, so idle pairs are almost free.
+	 * @note The lost radius is captured on lock.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Distance", meta = (EditCondition = "bDistanceCheck", EditConditionHides))
+	bool bEventDrivenDistanceCheck;
+
 public: /** View */
 
 	/** The angle of the cone relative to the view direction within which the Target must be. */
@@ -293,6 +376,33 @@ public: /** Target Switching */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "TargetSwitching", meta = (ClampMin = 0.f, ClampMax = 180.f, Units = "deg"))
 	float PlayerInputAngularRange;
 
+	/**
+	 * Whether the best switch candidate in each screen-space direction sector is maintained while the Target is locked.
+	 * A switch is then answered with a lookup and a single validation, falling back to the full search if it fails.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "TargetSwitching")
+	bool bPrecomputeSwitchTargets;
+
+	/** Number of the direction sectors. */
+	UPROPERTY(EditDefaultsOnly, Category = "TargetSwitching", meta = (EditCondition = "bPrecomputeSwitchTargets", EditConditionHides, ClampMin = 4, ClampMax = 32))
+	int32 SwitchSectorsNum;
+
+	/** Number of Targets evaluated per frame while updating the sectors. */
+	UPROPERTY(EditDefaultsOnly, Category = "TargetSwitching", meta = (EditCondition = "bPrecomputeSwitchTargets", EditConditionHides, ClampMin = 1))
+	int32 SwitchTargetsPerFrame;
+
+	/** A new update of the sectors starts at this interval after the previous one has started. */
+	UPROPERTY(EditDefaultsOnly, Category = "TargetSwitching", meta = (EditCondition = "bPrecomputeSwitchTargets", EditConditionHides, ClampMin = 0.f, Units = "s"))
+	float SwitchSectorsUpdateInterval;
+
+	/** A new update of the sectors starts earlier if the view has rotated further than this angle since the previous one. */
+	UPROPERTY(EditDefaultsOnly, Category = "TargetSwitching", meta = (EditCondition = "bPrecomputeSwitchTargets", EditConditionHides, ClampMin = 0.f, ClampMax = 180.f, Units = "deg"))
+	float SwitchSectorsViewAngleTolerance;
+
+	/** Sectors older than this are ignored. */
+	UPROPERTY(EditDefaultsOnly, Category = "TargetSwitching", meta = (EditCondition = "bPrecomputeSwitchTargets", EditConditionHides, ClampMin = 0.f, Units = "s"))
+	float SwitchSectorsMaxAge;
+
 public: /** Line Of Sight */
 
 	/** Target must be successfully traced without hitting any objects. The Target and Owner will be ignored. */
@@ -307,45 +417,303 @@ public: /** Line Of Sight */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides, Units = "s"))
 	float LostTargetDelay;
 
-	/** Captured Target trace interval. Traces each frame if <= 0.f. */
+	/**
+	 * Captured Target trace interval. Traces each frame if <= 0.f. Checked on the instigator tick, which is slowed down by the significance.
+	 * Also the lower bound of the adaptive interval. bAdaptiveCheckInterval.
+	 */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0", EditConditionHides, Units = "s"))
 	float CheckInterval;
 
+	/**
+	 * Whether the trace interval of the visible captured Target adapts to how likely the visibility is to change.
+	 * The interval is bounded by [CheckInterval, MaxCheckInterval]: CheckInterval is the floor, there is no separate minimum.
+	 * The interval grows from CheckInterval to MaxCheckInterval while the Target stays visible and barely moves across the view.
+	 * The occluded or newly captured Target is traced at CheckInterval, so the adaptation never traces more often than the fixed interval.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0", EditConditionHides))
+	bool bAdaptiveCheckInterval;
+
+	/** The upper bound of the adaptive trace interval. Losing the line of sight is noticed with up to this delay. Never less than CheckInterval. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0 && bAdaptiveCheckInterval", EditConditionHides, ClampMin = 0.f, Units = "s"))
+	float MaxCheckInterval;
+
+	/** Angular speed of the Target across the view at which the CheckInterval is used. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0 && bAdaptiveCheckInterval", EditConditionHides, ClampMin = 1.f, Units = "DegreesPerSecond"))
+	float AdaptiveAngularSpeed;
+
+	/** How long the Target must stay visible to reach the MaxCheckInterval. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0 && bAdaptiveCheckInterval", EditConditionHides, ClampMin = 0.01f, Units = "s"))
+	float AdaptiveStableTime;
+
+	/** Whether the captured Target is traced asynchronously. The result is applied in the next frame. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0", EditConditionHides))
+	bool bAsyncLineOfSightCheck;
+
+	/**
+	 * Number of the best candidates that pass the other checks traced at once by async traces in FindTargetAsync().
+	 * The best visible one is picked once the results are in, so the response is delayed by a frame. The rest are traced one by one if none is visible.
+	 * FindTarget() and detailed responses trace candidates one by one. Disabled if <= 1.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides, ClampMin = 0, ClampMax = 16))
+	int32 SpeculativeLineOfSightCandidates;
+
+	/**
+	 * How long line of sight results are reused. Results are shared via the TargetManager by all instigators. Disabled if <= 0.f.
+	 * Should be at least CheckInterval, so that the captured Target results are reused by the other handlers until the next check.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides, ClampMin = 0.f, Units = "s"))
+	float LineOfSightCacheDuration;
+
+	/** A cached result is discarded if the viewer or the Target has moved further than this distance. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LineOfSight", meta = (EditCondition = "bLineOfSightCheck && LineOfSightCacheDuration > 0", EditConditionHides, ClampMin = 0.f, Units = "cm"))
+	float LineOfSightCacheTolerance;
+
+public: /** Async Finding */
+
+	/**
+	 * Whether the primary and solver passes of FindTargetAsync() run on a worker thread. The response is applied in the next frame.
+	 * Blueprint overrides of FindTarget() and CalculateTargetWeight() as well as detailed responses force the synchronous path.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "AsyncFinding")
+	bool bAsyncFindTarget;
+
+public: /** Lightweight Targets */
+
+	/**
+	 * Whether lightweight Targets without actors are found alongside the regular ones. UTargetManager::RegisterLightweightTarget().
+	 * The best visible lightweight Target is returned in FFindTargetRequestResponse::LightweightTarget if no regular candidate has a better weight,
+	 * and promoted to an actor only once the instigator captures it. Requires the native batch solver. Not included in detailed responses.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LightweightTargets")
+	bool bFindLightweightTargets;
+
+	/** Crowds might be large, so only this number of the best lightweight Targets is traced per request. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "LightweightTargets", meta = (EditCondition = "bFindLightweightTargets", EditConditionHides, ClampMin = 1, ClampMax = 16))
+	int32 MaxLightweightLineOfSightTraces;
+
+public: /** Incremental Finding */
+
+	/** The view must move further than this distance to re-score the incremental candidates by the batch solver. FindTargetIncremental(). */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "IncrementalFinding", meta = (ClampMin = 0.f, Units = "cm"))
+	float IncrementalViewTolerance;
+
+	/** The view must rotate further than this angle to re-score the incremental candidates. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "IncrementalFinding", meta = (ClampMin = 0.f, ClampMax = 180.f, Units = "deg"))
+	float IncrementalViewAngleTolerance;
+
+	/** The Target must move further than this distance to be re-sampled. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "IncrementalFinding", meta = (ClampMin = 0.f, Units = "cm"))
+	float IncrementalTargetTolerance;
+
+	/** All candidates are re-sampled at this interval regardless of changes. Also re-sampled once any Target is (un)registered or refreshed. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "IncrementalFinding", meta = (ClampMin = 0.f, Units = "s"))
+	float IncrementalFullUpdateInterval;
+
+	/** The previous Target is kept unless the new one's weight is lower by this ratio. Avoids flickering between similar Targets. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "IncrementalFinding", meta = (ClampMin = 0.f, ClampMax = 1.f, Units = "x"))
+	float IncrementalHysteresis;
+
 private: /** Internal */
 
 	FTimerHandle LineOfSightExpirationHandle;
 	float LineOfSightCheckTimer;
 
+	//Adaptive line of sight check state. bAdaptiveCheckInterval.
+	float AdaptiveCheckInterval;
+	float LastLineOfSightTime;
+	float LineOfSightResultTime;
+	FVector LastLineOfSightDirection;
+	bool bLastLineOfSightVisible;
+
+	//Pending async trace of the captured Target. Results of other traces are ignored.
+	FTraceHandle PendingLineOfSightTrace;
+	FLineOfSightQuery PendingLineOfSightQuery;
+	FTraceDelegate LineOfSightTraceDelegate;
+
+	//Blueprint overrides of the native events. Not overridden events are called via _Implementation.
+	bool bIsCalculateTargetWeightOverridden;
+	bool bIsShouldSkipTargetCustomOverridden;
+	bool bIsGetPointOfViewOverridden;
+
+	//The best switch candidate in the direction sector. The Target is kept by the handle, as it might be destroyed before the sector is read.
+	struct FSwitchSector
+	{
+		FTargetHandle TargetHandle;
+		FName Socket = NAME_None;
+		float Weight = TNumericLimits<float>::Max();
+	};
+
+	//Switch sectors are rebuilt over several frames. Targets are evaluated relative to the captured one.
+	TArray<FSwitchSector> SwitchSectors;
+	TArray<FSwitchSector> PendingSwitchSectors;
+	TArray<FTargetHandle> PendingSwitchTargets;
+	float SwitchSectorsUpdateTime;
+	float PendingSwitchSectorsTime;
+	FVector PendingSwitchSectorsViewDirection;
+	bool bBuildingSwitchSectors;
+
+	//Pending FindTargetAsync() request. Only the latest one is completed.
+	UE::Tasks::FTask PendingFindTargetTask;
+	TSharedPtr<FWeightedFindTargetTask> PendingFindTargetData;
+	FOnFindTargetRequestCompleted PendingFindTargetCallback;
+
+	//Best candidates of the FindTargetAsync() request whose async traces are in flight. SpeculativeLineOfSightCandidates.
+	TSharedPtr<FWeightedSpeculativeLineOfSight> PendingSpeculativeLineOfSight;
+	FTraceDelegate SpeculativeLineOfSightTraceDelegate;
+
+	//Caller-owned buffer of the FindTargetDetailed() request. Consumed by the first detailed response.
+	FWeightedDetailedResponseData* DetailedResponseBuffer;
+
+	//Targets data buffer reused between requests. Swapped with the caller-owned detailed response buffer.
+	TArray<FTargetContext> TargetsDataScratch;
+
+	//Incremental finding state. Candidates include all Sockets of the sampled Targets, the range is checked per call.
+	//They keep the weights from the evaluation they were sampled or re-scored in.
+	TArray<FTargetContext> IncrementalCandidates;
+	TMap<const UTargetComponent*, FVector> IncrementalTargetLocations;
+	FTargetInfo IncrementalTarget;
+	FVector IncrementalViewLocation;
+	FVector IncrementalViewDirection;
+	float IncrementalFullUpdateTime;
+	uint32 IncrementalTargetsVersion;
+
 protected: /** Finding */
 
 	/** The actual FindTarget() implementation. */
 	FFindTargetRequestResponse FindTargetBatched(FFindTargetContext& Context);
 
+	/**
+	 * Performs the primary, screen culling and solver passes and removes the candidates worse than the best lightweight Target.
+	 * @param OutLightweightTarget - The best visible lightweight Target. Not set if there is none.
+	 */
+	void GatherWeightedCandidates(FFindTargetContext& Context, TArray<FTargetContext>& OutTargetsData, FTargetHandle& OutLightweightTarget);
+
 	/** Quickly rejects all invalid Targets. */
 	void PerformPrimarySamplingPass(FFindTargetContext& Context, TArray<FTargetContext>& OutTargetsData);
 
-	/** Whether to skip the Target during the primary pass. */
-	bool ShouldSkipTargetPrimaryPass(const FFindTargetContext& Context, const UTargetComponent* Target) const;
+	/** Gathers snapshot indices of the Targets to be sampled. */
+	void GatherPrimaryCandidates(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, TArray<int32>& OutTargetIndices) const;
+
+	/** Samples all Sockets of the Target from the snapshot. */
+	void SampleTargetPrimaryPass(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData);
+
+	/** Samples all Sockets of the Target that has passed the primary checks. */
+	void ExpandTargetSockets(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData) const;
+
+	/** Scores Targets by their bounds and keeps only the best MaxExpandedTargets of them. */
+	void SelectTargetsToExpand(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, TArray<int32>& InOutTargetIndices) const;
+
+	/** Whether the Target Socket is within the view cone and the input range. Calculates DeltaAngle2D in the Switch mode. */
+	static bool IsTargetContextInRange(const FFindTargetContext& Context, FTargetContext& TargetContext);
+
+	/** Whether to skip the Target from the snapshot during the primary pass. */
+	bool ShouldSkipTargetPrimaryPass(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex) const;
+
+	/** Removes all Targets outside the screen in one vectorized pass. */
+	void PerformScreenCullingPass(FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData) const;
+
+	/** Projects all locations in one vectorized pass and checks whether they're on the screen. Thread-safe. */
+	static void CalcOnScreen(const FFindTargetContext& Context, TArrayView<const FVector> Locations, TBitArray<>& OutOnScreen);
 
 	/** Calculates the weight for each Target. */
 	void PerformSolverPass(FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData);
 
+	/**
+	 * Whether weights can be calculated by the native batch solver.
+	 * Native subclasses overriding CalculateTargetWeight_Implementation() should return false.
+	 */
+	virtual bool CanUseBatchSolver() const;
+
+	/** Precomputes the batch solver coefficients. */
+	FWeightedTargetSolverParams MakeSolverParams(const FFindTargetContext& Context) const;
+
+	/** Calculates weights by the batch solver. Priorities match the Targets data. Thread-safe. */
+	static void SolveTargetWeights(const FFindTargetContext& Context, const FWeightedTargetSolverParams& Params, TArrayView<const float> Priorities, TArray<FTargetContext>& InOutTargetsData);
+
 	/** Calculates the weight for the Target. */
 	UFUNCTION(BlueprintNativeEvent, Category = "LockOnTarget|WeightedTargetHandler")
 	float CalculateTargetWeight(const FFindTargetContext& Context, const FTargetContext& TargetContext) const;
 	virtual float CalculateTargetWeight_Implementation(const FFindTargetContext& Context, const FTargetContext& TargetContext) const;
 
-	/** Finds the first Target that passes the remaining checks. */
+	/**
+	 * Finds the best Target that passes the remaining checks.
+	 * Expects InTargetsData to be sorted if a detailed response is requested, otherwise to be a heap.
+	 */
 	FFindTargetRequestResponse PerformSecondarySamplingPass(FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData);
 
 	/** Whether to skip the Target during the secondary pass. */
-	bool ShouldSkipTargetSecondaryPass(const FFindTargetContext& Context, const FTargetContext& TargetContext) const;
+	bool ShouldSkipTargetSecondaryPass(const FFindTargetContext& Context, const FTargetContext& TargetContext, bool bCheckLineOfSight = true) const;
+
+
+	/**
+	 * Finds the best visible lightweight Target and removes the weighted regular candidates that are worse than it.
+	 * Returns false if there is none. Shared by the sync and async finding, so both return the same result. bFindLightweightTargets.
+	 */
+	bool FilterByLightweightTarget(const FFindTargetContext& Context, TArray<FTargetContext>& InOutTargetsData, FTargetHandle& OutHandle) const;
+
+	/** Finds the best visible lightweight Target. Returns false if there is none. */
+	bool FindLightweightTarget(const FFindTargetContext& Context, FTargetHandle& OutHandle, float& OutWeight) const;
 
 	/** Whether to skip the Target during the secondary pass. */
 	UFUNCTION(BlueprintNativeEvent, Category = "LockOnTarget|WeightedTargetHandler")
 	bool ShouldSkipTargetCustom(const FFindTargetContext& Context, const FTargetContext& TargetContext) const;
 	virtual bool ShouldSkipTargetCustom_Implementation(const FFindTargetContext& Context, const FTargetContext& TargetContext) const { return false; };
 
+	/** Evaluates the next portion of Targets for the switch sectors. Called while the Target is locked. */
+	void UpdateSwitchSectors(const FRotator& ViewRotation);
+
+	/** Returns the validated precomputed switch Target in the input direction or NULL_TARGET. */
+	FTargetInfo FindPrecomputedSwitchTarget(const FFindTargetContext& Context);
+
+	/** Clears the switch sectors. */
+	void ResetSwitchSectors();
+
+	int32 GetSwitchSectorIndex(const FVector2D& Direction) const;
+	FVector2D GetSwitchSectorDirection(int32 SectorIndex) const;
+
+	/** Whether FindTargetAsync() can run on a worker thread. */
+	bool CanFindTargetOffGameThread(const FFindTargetRequestParams& RequestParams) const;
+
+	/** Copies the candidates data on the game thread, so that the worker doesn't touch any UObject. */
+	void CaptureFindTargetTask(FWeightedFindTargetTask& Task);
+
+	/** Performs the primary and solver passes on the captured data. Thread-safe. */
+	static void PerformFindTargetTask(FWeightedFindTargetTask& Task);
+
+	/**
+	 * Resolves the Targets of the pending task by their handles, applies the sort and secondary passes and completes the request.
+	 * The request is restarted if the mode or the captured Target has changed since the capture.
+	 */
+	void CompletePendingFindTarget();
+
+	/** Waits for the pending task and drops the request. */
+	void CancelPendingFindTarget();
+
+	/** Whether the secondary pass of FindTargetAsync() traces the best candidates at once. SpeculativeLineOfSightCandidates. */
+	bool CanTraceSpeculatively(const FFindTargetRequestParams& RequestParams) const;
+
+	/**
+	 * Traces the best candidates of the heap at once by async traces and completes the request with the best visible one once the results are in.
+	 * Cached results are reused, and the request is completed immediately if they're enough.
+	 */
+	void PerformSpeculativeSecondaryPass(FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData, const FTargetHandle& LightweightTarget, FOnFindTargetRequestCompleted&& OnCompleted);
+	void OnSpeculativeLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** Resolves the traced candidates by their handles and completes the request with the best visible one. The rest are traced one by one if none is visible. */
+	void CompleteSpeculativeLineOfSight();
+
+	/** Re-samples only the Targets whose inputs have changed since the previous call. */
+	FFindTargetRequestResponse FindTargetIncrementalBatched(FFindTargetContext& Context);
+
+	/** Adds all Sockets of the Target to the incremental candidates. */
+	void SampleIncrementalTarget(const FFindTargetContext& Context, FTargetSnapshot& Snapshot, int32 TargetIndex, TArray<FTargetContext>& OutTargetsData) const;
+
+	/** Updates the view dependent data of the incremental candidates and re-calculates their weights. */
+	void RescoreIncrementalCandidates(FFindTargetContext& Context);
+
+	/** Clears the candidates of the previous incremental call. */
+	void ResetIncrementalState();
+
 	/** Generates a detailed response based on the data. */
 	virtual UWeightedTargetHandlerDetailedResponse* GenerateDetailedResponse(const FFindTargetContext& Context, TArray<FTargetContext>& InTargetsData);
 
@@ -354,22 +722,40 @@ protected: /** Helpers */
 	/** Handles target unlock events. */
 	virtual void HandleTargetUnlock(ETargetUnlockReason UnlockReason);
 
+	//Called by the TargetManager when the captured Target has left the lost radius. bEventDrivenDistanceCheck.
+	void OnCapturedTargetLeftRadius();
+
+	//Returns the view location used by the distance check.
+	FVector GetDistanceCheckViewLocation() const;
+
 	/** Tries to find a new Target and capture it if found. */
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget|WeightedTargetHandler", meta = (BlueprintProtected))
 	void TryFindTarget(bool bClearTargetIfFailed = true);
 
+	/** TryFindTarget() workhorse. Performed immediately or by the UFindTargetScheduler. */
+	void PerformTryFindTarget(bool bClearTargetIfFailed);
+
 	/** Creates and initially populates FindTargetContext. */
 	FFindTargetContext CreateFindTargetContext(EFindTargetContextMode Mode, const FFindTargetRequestParams& RequestParams);
 
 	/** Creates and initially populates TargetContext. */
 	FTargetContext CreateTargetContext(const FFindTargetContext& Context, const FTargetInfo& InTarget);
 
+	/** Creates and initially populates TargetContext with the already known Socket location. */
+	FTargetContext CreateTargetContext(const FFindTargetContext& Context, const FTargetInfo& InTarget, const FVector& SocketLocation) const;
+
 	/** Calculates the delta angle 2D between the player's input and the direction towards the Target. */
 	void CalcDeltaAngle2D(const FFindTargetContext& Context, FTargetContext& OutTargetContext) const;
 
+	/** Calculates the delta direction 2D towards the Target. Returns the cosine of the delta angle 2D. */
+	static float CalcDeltaDirection2D(const FFindTargetContext& Context, FTargetContext& OutTargetContext);
+
 	/** Returns the capture radius for the Target. */
 	float GetTargetCaptureRadius(const UTargetComponent* InTarget) const;
 
+	/** Captures the view projection and the screen limits for the screen checks. */
+	void CaptureScreenData(FFindTargetContext& Context) const;
+
 	/** Whether the Target is on the screen. */
 	bool IsTargetOnScreen(const FFindTargetContext& Context, const FTargetContext& TargetContext) const;
 
@@ -383,7 +769,25 @@ protected: /** Line Of Sight */
 	virtual void StartLineOfSightTimer();
 	virtual void StopLineOfSightTimer();
 	virtual void OnLineOfSightTimerExpired();
-	bool LineOfSightTrace(const FVector& From, const FVector& To, const AActor* const TargetToIgnore) const;
+	bool LineOfSightTrace(const FVector& From, const FVector& To, const AActor* const TargetToIgnore, const AActor** OutBlockingActor = nullptr) const;
+
+	/** Returns the captured Target trace interval. */
+	float GetLineOfSightCheckInterval() const;
+
+	/** Applies the captured Target line of sight result. Updates the lost Target timer and the adaptive interval. */
+	void ApplyLineOfSightResult(const FLineOfSightQuery& Query, bool bIsVisible);
+	void ResetAdaptiveLineOfSight();
+	FCollisionQueryParams MakeLineOfSightQueryParams(const AActor* const TargetToIgnore) const;
+
+	/** Traces the Target Socket reusing the shared cached result if possible. */
+	bool CachedLineOfSightTrace(const FVector& From, const FTargetInfo& Target, const FVector& TargetLocation) const;
+	FLineOfSightQuery MakeLineOfSightQuery(const FVector& From, const FTargetInfo& Target, const FVector& TargetLocation) const;
+	bool FindCachedLineOfSight(const FLineOfSightQuery& Query, bool& bOutVisible) const;
+	void CacheLineOfSight(const FLineOfSightQuery& Query, bool bIsVisible, const AActor* BlockingActor = nullptr) const;
+
+	/** Issues an async trace of the captured Target. Does nothing if the previous one is still pending. */
+	void AsyncLineOfSightTrace(const FLineOfSightQuery& Query, const AActor* const TargetToIgnore);
+	void OnAsyncLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
 
 protected: /** Overrides */
 
@@ -393,6 +797,9 @@ protected: /** Overrides */
 	virtual void HandleTargetException_Implementation(const FTargetInfo& Target, ETargetExceptionType Exception) override;
 
 	//LockOnTargetModuleBase
+	virtual void Initialize(ULockOnTargetComponent* Instigator) override;
+	virtual void Deinitialize(ULockOnTargetComponent* Instigator) override;
+	virtual void OnTargetLocked(UTargetComponent* Target, FName Socket) override;
 	virtual void OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Socket) override;
 };
 
@@ -4,16 +4,59 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
+#include "TargetSpatialGrid.h"
+#include "TargetSnapshot.h"
+#include "LineOfSightCache.h"
 #include "TargetManager.generated.h"
 
 class UTargetComponent;
 class UWorld;
+class AActor;
+class USceneComponent;
+
+/** Returns the view location the distance to the locked Target is measured from. */
+DECLARE_DELEGATE_RetVal(FVector, FLockedTargetViewLocation);
+
+/** Spawns or finds an actor for the lightweight Target and returns its registered Target component. Returns nullptr if the promotion failed. */
+DECLARE_DELEGATE_RetVal_OneParam(UTargetComponent*, FPromoteLightweightTarget, const FTargetHandle& /*Handle*/);
+
+/**
+ * A Target record without an actor, e.g. a crowd entity simulated by Mass.
+ * Lightweight Targets are found alongside the regular ones and promoted to a real actor only when captured.
+ * The owner is expected to update the location, e.g. from a Mass processor reading the transform fragment.
+ */
+struct FLightweightTarget
+{
+	//World location of the Target.
+	FVector Location = FVector::ZeroVector;
+
+	//Offset of the captured point from the location. E.g. the head height.
+	FVector SocketOffset = FVector::ZeroVector;
+
+	//Overrides the capture radius of the handler if > 0.
+	float CaptureRadius = 0.f;
+
+	//UTargetComponent::Priority.
+	float Priority = 0.5f;
+
+	//ETargetingChannel.
+	uint8 TargetingChannels = static_cast<uint8>(ETargetingChannel::Default);
+
+	FVector GetSocketLocation() const { return Location + SocketOffset; }
+};
 
 /** 
  * A simple manager that keeps track of registered Targets.
+ * Keeps a spatial index of the Targets to quickly gather the ones within a capture radius and view cone.
+ * Targets are partitioned by targeting channels, so instigators only gather the ones they can target.
+ * Keeps a snapshot of the Targets data and a line of sight cache shared by all instigators.
+ * Tracks locked pairs and notifies when the Target leaves the radius. A pair is re-evaluated only when it could have crossed the radius.
+ * Keeps lightweight Targets without actors, promoted to regular ones once captured.
  */
 UCLASS()
-class LOCKONTARGET_API UTargetManager final : public UWorldSubsystem
+class LOCKONTARGET_API UTargetManager final : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
@@ -22,27 +65,192 @@ public:
 	UTargetManager();
 	static UTargetManager& Get(UWorld& InWorld);
 
+	/** Max delay between the locked pair checks. Covers teleports and accelerations not reflected in the velocity. */
+	static constexpr float MaxLockedPairCheckDelay = 0.5f;
+
 private: /** Internal */
 
-	//All registered Targets.
-	TSet<UTargetComponent*> RegisteredTargets;
+	struct FTargetSlot
+	{
+		int32 DenseIndex = INDEX_NONE;
+		uint32 Generation = 0;
+
+		//The owner root and the associated components whose transform updates mark the Target as moved.
+		//The associated component might move relative to the root, e.g. an attached mesh.
+		TWeakObjectPtr<USceneComponent> RootComponent;
+		FDelegateHandle RootTransformUpdatedHandle;
+		TWeakObjectPtr<USceneComponent> AssociatedComponent;
+		FDelegateHandle AssociatedTransformUpdatedHandle;
+		bool bMoved = false;
+	};
+
+	//All registered Targets densely packed. Removal swaps the last Target in.
+	TArray<UTargetComponent*> RegisteredTargets;
+
+	//Slot index of each registered Target in the same order as RegisteredTargets.
+	TArray<int32> RegisteredTargetSlots;
+
+	//Handle slots pointing to the dense index of the Target.
+	TArray<FTargetSlot> TargetSlots;
+	TArray<int32> FreeTargetSlots;
+
+	//Slots of the Targets moved since the last spatial index update. Only these are updated in the grid.
+	TArray<int32> MovedTargetSlots;
+
+	//Spatial index of registered Targets.
+	FTargetSpatialGrid SpatialGrid;
+
+	//Snapshot of registered Targets.
+	FTargetSnapshot TargetSnapshot;
+
+	//Line of sight results shared by all instigators.
+	FLineOfSightCache LineOfSightCache;
+
+	//Targets with the forced custom capture radius. Collected on the snapshot rebuild, their radii are read live.
+	TArray<UTargetComponent*> CustomCaptureRadiusTargets;
+
+	//Incremented on (un)registration and refresh of any Target.
+	uint32 TargetsVersion;
+
+	struct FLockedPair
+	{
+		TWeakObjectPtr<const UObject> Owner;
+		TWeakObjectPtr<const AActor> Instigator;
+		TWeakObjectPtr<UTargetComponent> Target;
+		float Radius = 0.f;
+		double NextCheckTime = 0.0;
+
+		//The view might move on its own, e.g. an orbiting camera. Its speed is estimated between the checks.
+		FVector LastViewLocation = FVector::ZeroVector;
+		double LastCheckTime = -1.0;
+
+		FLockedTargetViewLocation GetViewLocation;
+		FSimpleDelegate OnExit;
+	};
+
+	//Locked pairs watched for the radius exit.
+	TArray<FLockedPair> LockedPairs;
+
+	//Lightweight Targets densely packed. Removal swaps the last one in.
+	TArray<FLightweightTarget> LightweightTargets;
+	TArray<FPromoteLightweightTarget> LightweightPromoters;
+
+	//Slot index of each lightweight Target in the same order as LightweightTargets.
+	TArray<int32> LightweightTargetSlots;
+
+	//Handle slots pointing to the dense index of the lightweight Target. Separate from the regular Target handles.
+	TArray<FTargetSlot> LightweightSlots;
+	TArray<int32> FreeLightweightSlots;
+
+	//The snapshot per-frame data is invalidated on the first access in the frame and shared by all tick groups.
+	uint64 TargetDataUpdateFrame;
+
+	//The snapshot structure is only rebuilt if set. Per-frame data doesn't require the rebuild.
+	bool bTargetDataDirty;
 
 public: 
 
 	//Target registration
 	bool RegisterTarget(UTargetComponent* Target);
 	bool UnregisterTarget(UTargetComponent* Target);
-	bool IsTargetRegistered(UTargetComponent * Target) const { return RegisteredTargets.Contains(Target); }
+	//The Target is dereferenced, so it must be alive. Stored Targets should be resolved by their handles via GetTarget().
+	bool IsTargetRegistered(const UTargetComponent* Target) const;
 
-	//Gets all registered Targets
+	//Returns the dense index of the Target by its handle or INDEX_NONE if the handle is dangling.
+	int32 GetTargetIndex(const FTargetHandle& Handle) const;
+
+	//Returns the Target by its handle or nullptr if the handle is dangling.
+	UTargetComponent* GetTarget(const FTargetHandle& Handle) const;
+
+	//Gets all registered Targets. The order changes on unregistration.
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
-	const TSet<UTargetComponent*>& GetRegisteredTargets() const { return RegisteredTargets; }
+	const TArray<UTargetComponent*>& GetRegisteredTargets() const { return RegisteredTargets; }
 
 	//Gets the number of registered Targets
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
 	int32 GetRegisteredTargetsNum() const { return RegisteredTargets.Num(); }
 
+	/**
+	 * Gathers registered Targets whose location is within the radius and whose bounds intersect the view cone.
+	 * The result is conservative, so exact checks should still be performed.
+	 * @param ConeHalfAngle - Half angle of the cone in degrees. The cone check is skipped if >= 180.
+	 * @param ChannelMask - Only Targets in any of these channels are gathered. ETargetingChannel.
+	 */
+	void QueryTargets(const FVector& Origin, float Radius, const FVector& ConeDirection, float ConeHalfAngle, TArray<UTargetComponent*>& OutTargets, uint8 ChannelMask = MAX_uint8);
+
+	//Updates the cached Target data that isn't refreshed every frame. E.g. when the Target channels or the associated component have changed.
+	void RefreshTarget(UTargetComponent* Target);
+
+	//Changes whenever a Target is (un)registered or refreshed, e.g. its channels have changed. Used to invalidate data derived from the Targets.
+	uint32 GetTargetsVersion() const { return TargetsVersion; }
+
+	//Gets the largest custom capture radius among registered Targets.
+	float GetMaxCustomCaptureRadius();
+
+	/**
+	 * Gets the snapshot of registered Targets for the current frame. Locations are evaluated on the first access in the frame.
+	 * @note The reference must not be stored as the snapshot is rebuilt after (un)registration.
+	 */
+	FTargetSnapshot& GetTargetSnapshot();
+
+	//Gets the line of sight results shared by all instigators.
+	FLineOfSightCache& GetLineOfSightCache() { return LineOfSightCache; }
+
+	//Forces the snapshot to be rebuilt on the next access. E.g. when Target Sockets have changed.
+	void InvalidateTargetData() { bTargetDataDirty = true; }
+
+	/**
+	 * Watches the distance between the view and the locked Target. OnExit is called once the distance exceeds the radius and the pair is removed.
+	 * The next check is scheduled from the separation margin, the velocities of the Instigator and the Target owner and the view speed since the last check.
+	 * Replaces the pair of the same owner.
+	 */
+	void WatchLockedTarget(const UObject* Owner, const AActor* Instigator, UTargetComponent* Target, float Radius, FLockedTargetViewLocation&& GetViewLocation, FSimpleDelegate&& OnExit);
+
+	//Stops watching the pair of the owner.
+	void UnwatchLockedTarget(const UObject* Owner);
+
+	int32 GetLockedPairsNum() const { return LockedPairs.Num(); }
+
+	/** Registers the lightweight Target. The promoter is called once the Target is about to be captured. */
+	FTargetHandle RegisterLightweightTarget(const FLightweightTarget& Target, FPromoteLightweightTarget&& Promoter);
+
+	//Returns false if the handle is dangling.
+	bool UnregisterLightweightTarget(const FTargetHandle& Handle);
+
+	//Returns the lightweight Target for updating or nullptr if the handle is dangling.
+	FLightweightTarget* FindLightweightTarget(const FTargetHandle& Handle);
+
+	//Gets all lightweight Targets. The order changes on unregistration.
+	TArrayView<const FLightweightTarget> GetLightweightTargets() const { return LightweightTargets; }
+
+	//Returns the handle of the lightweight Target by its index in GetLightweightTargets().
+	FTargetHandle GetLightweightTargetHandle(int32 DenseIndex) const;
+
+	/**
+	 * Promotes the lightweight Target to a regular one. The lightweight Target is unregistered on success.
+	 * @return The registered Target component or nullptr if the promotion failed.
+	 */
+	UTargetComponent* PromoteLightweightTarget(const FTargetHandle& Handle);
+
+private:
+
+	//Updates the moved Targets in the spatial index, rebuilds the snapshot if invalidated and starts its new frame.
+	void UpdateTargetData();
+
+	//Updates the moved Targets in the spatial index.
+	void UpdateMovedTargets();
+	void WatchTargetTransform(FTargetSlot& Slot, int32 SlotIndex, const UTargetComponent* Target);
+	void UnwatchTargetTransform(FTargetSlot& Slot);
+	void OnTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 SlotIndex);
+
+	//Checks the locked pair. Returns false if the Target has left the radius or the pair is no longer valid.
+	bool CheckLockedPair(FLockedPair& Pair, double Time) const;
+
 protected: /** Overrides */
+
+	//UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
 	
 	//UWorldSubsystem
 	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
@@ -0,0 +1,101 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LockOnTargetTypes.h"
+
+class UTargetComponent;
+
+/**
+ * Structure-of-arrays snapshot of all registered Targets, shared by all instigators.
+ * The structure (Targets, Sockets and channel partitions) is only rebuilt when the registered Targets change.
+ * Per-frame data (actor and socket locations, render time and bounds) is evaluated on the first access in the frame,
+ * so only the queried Targets pay for it and each socket transform is evaluated at most once per frame regardless of the number of instigators.
+ * Priority and capture radius are read from the Target directly.
+ *
+ * Owned by UTargetManager. Must only be accessed on the game thread.
+ */
+struct LOCKONTARGET_API FTargetSnapshot
+{
+public:
+
+	/**
+	 * Rebuilds the snapshot structure from the given Targets.
+	 * @param NumHandleSlots - Number of the TargetManager handle slots. Used to look up the Targets by their handles.
+	 */
+	void Build(TArrayView<UTargetComponent* const> InTargets, int32 NumHandleSlots);
+
+	/** Invalidates the per-frame data of all Targets. Doesn't touch the Targets. */
+	void BeginFrame();
+
+	/** Removes all Targets. */
+	void Reset();
+
+	int32 Num() const { return Targets.Num(); }
+
+	/** Returns the index of the Target or INDEX_NONE if it isn't in the snapshot. */
+	int32 FindTargetIndex(const UTargetComponent* Target) const;
+
+	UTargetComponent* GetTarget(int32 Index) const { return Targets[Index]; }
+	float GetPriority(int32 Index) const;
+	uint8 GetChannels(int32 Index) const { return Channels[Index]; }
+
+	/** Returns the location of the Target owner. Evaluated on first access. */
+	const FVector& GetActorLocation(int32 Index);
+
+	/** Gathers indices of the Targets in any of the channels. ETargetingChannel. */
+	void GatherTargetIndices(uint8 ChannelMask, TArray<int32>& OutIndices) const;
+
+	/** Returns the custom capture radius if it's forced, otherwise the default one. */
+	float GetCaptureRadius(int32 Index, float DefaultCaptureRadius) const;
+
+	/** Returns the last render time of the Target owner. Evaluated on first access. */
+	float GetLastRenderTime(int32 Index);
+
+	/** Returns the bounding sphere of the Target associated component. Covers the Sockets without evaluating them. Evaluated on first access. */
+	const FSphere& GetBounds(int32 Index);
+
+	/** Returns all Sockets of the Target. */
+	TArrayView<const FName> GetSockets(int32 Index) const { return MakeArrayView(SocketNames.GetData() + SocketStarts[Index], SocketNums[Index]); }
+
+	/** Returns world locations of all Sockets of the Target in the same order as GetSockets(). Evaluated on first access. */
+	TArrayView<const FVector> GetSocketLocations(int32 Index);
+
+	/** Returns the world location of the Socket. Falls back to the live location if the Socket isn't in the snapshot. */
+	FVector GetSocketLocation(int32 Index, FName Socket);
+
+private:
+
+	void EvaluateSockets(int32 Index);
+
+	//Whether the per-frame data is evaluated in the current frame.
+	bool IsEvaluated(const TArray<uint32>& Stamps, int32 Index) const { return Stamps[Index] == FrameStamp; }
+
+	TArray<UTargetComponent*> Targets;
+	TArray<uint8> Channels;
+
+	//Per-frame data. Valid if its stamp matches the FrameStamp.
+	TArray<FVector> ActorLocations;
+	TArray<float> LastRenderTimes;
+	TArray<FSphere> Bounds;
+	TArray<uint32> LocationStamps;
+	TArray<uint32> RenderTimeStamps;
+	TArray<uint32> BoundsStamps;
+	TArray<uint32> SocketStamps;
+	uint32 FrameStamp = 1;
+
+	//Socket ranges per Target.
+	TArray<int32> SocketStarts;
+	TArray<int32> SocketNums;
+
+	//Sockets of all Targets.
+	TArray<FName> SocketNames;
+	TArray<FVector> SocketLocations;
+
+	//Target index per handle slot.
+	TArray<int32> SlotIndices;
+
+	//Target indices per targeting channel.
+	TArray<int32> ChannelPartitions[NumTargetingChannels];
+};
@@ -0,0 +1,94 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UTargetComponent;
+
+/**
+ * Uniform 2D (XY) hash grid of Target locations.
+ * Targets are moved between cells only when their cell changes. Each Target knows its index in the cell, so updates don't scan the cell.
+ * Only moved Targets are expected to be updated, i.e. when the owner root or the associated component moves.
+ *
+ * Queries are conservative, i.e. may return Targets slightly outside the requested volume,
+ * so the exact checks should still be performed by the caller.
+ */
+class LOCKONTARGET_API FTargetSpatialGrid
+{
+public:
+
+	/** Default size of the cell. Should be close to the typical capture radius. */
+	static constexpr float DefaultCellSize = 2000.f;
+
+	/** Extra tolerance added to the queries. Covers the movement after the last update in the current frame. */
+	static constexpr float QuerySlack = 50.f;
+
+	explicit FTargetSpatialGrid(float InCellSize = DefaultCellSize);
+
+public:
+
+	/** Adds the Target to the grid. */
+	void Add(UTargetComponent* Target);
+
+	/** Removes the Target from the grid. */
+	void Remove(UTargetComponent* Target);
+
+	/** Updates the Target location. Returns false if the Target isn't in the grid. */
+	bool Update(UTargetComponent* Target);
+
+	/** Removes all Targets. */
+	void Reset();
+
+	/** Whether the Target is in the grid. */
+	bool Contains(const UTargetComponent* Target) const { return TargetCells.Contains(Target); }
+
+	/** Number of Targets in the grid. */
+	int32 Num() const { return TargetCells.Num(); }
+
+	/**
+	 * Gathers Targets whose actor location is within the radius and whose bounds intersect the cone.
+	 * @param ConeHalfAngle - Half angle of the cone in degrees. The cone check is skipped if >= 180.
+	 * @param ChannelMask - Only Targets in any of these channels are gathered.
+	 */
+	void Query(const FVector& Origin, float Radius, const FVector& ConeDirection, float ConeHalfAngle, TArray<UTargetComponent*>& OutTargets, uint8 ChannelMask = MAX_uint8) const;
+
+private:
+
+	struct FCellItem
+	{
+		UTargetComponent* Target = nullptr;
+
+		//Owner location used for the distance check.
+		FVector Location = FVector::ZeroVector;
+
+		//Bounding sphere of the associated component, widened to contain all sockets at the time of the update.
+		FVector BoundsOrigin = FVector::ZeroVector;
+		float BoundsRadius = 0.f;
+
+		//Targeting channels of the Target. Cached on add.
+		uint8 Channels = 0;
+	};
+
+	struct FTargetCellInfo
+	{
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		//Index of the item in the cell.
+		int32 ItemIndex = INDEX_NONE;
+
+		//Static Targets are never updated.
+		bool bStatic = false;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+	void AddItem(FTargetCellInfo& CellInfo, const FCellItem& Item);
+	void RemoveItem(const FTargetCellInfo& CellInfo);
+	void ReadItem(FCellItem& Item) const;
+	bool IsItemInVolume(const FCellItem& Item, const FVector& Origin, float RadiusSq, const FVector& ConeDirection, float ConeHalfAngleRad) const;
+
+	TMap<FIntPoint, TArray<FCellItem>> Cells;
+	TMap<const UTargetComponent*, FTargetCellInfo> TargetCells;
+	float CellSize;
+	float InvCellSize;
+};
@@ -224,11 +224,10 @@ void FGameplayDebuggerCategory_LockOnTarget::SimulateTargetHandler(FGameplayDebu
 		{
 			FFindTargetRequestParams Params;
 			Params.PlayerInput = DecomposeAngle(SimulatedPlayerInput, true);
-			Params.bGenerateDetailedResponse = true;
 
-			const FFindTargetRequestResponse Response = TargetHandler->FindTarget(Params);
+			TargetHandler->FindTargetDetailed(SimulatedResponse, Params);
 
-			DrawWeights(CanvasContext, Response);
+			DrawWeights(CanvasContext, SimulatedResponse);
 			DrawPlayerInput(TargetHandler, CanvasContext);
 
 		}
@@ -239,22 +238,19 @@ void FGameplayDebuggerCategory_LockOnTarget::SimulateTargetHandler(FGameplayDebu
 	}
 }
 
-void FGameplayDebuggerCategory_LockOnTarget::DrawWeights(FGameplayDebuggerCanvasContext& CanvasContext, const FFindTargetRequestResponse& Response)
+void FGameplayDebuggerCategory_LockOnTarget::DrawWeights(FGameplayDebuggerCanvasContext& CanvasContext, const FWeightedDetailedResponseData& DetailedResponse)
 {
-	if (auto* const DetailedResponse = Cast<UWeightedTargetHandlerDetailedResponse>(Response.Payload))
-	{
-		int32 TargetsNum = DetailedResponse->TargetsData.Num();
+	int32 TargetsNum = DetailedResponse.TargetsData.Num();
 
-		for (int32 i = 0; i < TargetsNum; ++i)
-		{
-			const FColor DisplayColor = i == 0 ? FColor::Yellow : FColor::White;
-			const FVector2D ScreenLoc = CanvasContext.ProjectLocation(DetailedResponse->TargetsData[i].Location);
-			const FString ModifierString = FString::Printf(TEXT("%.2f"), DetailedResponse->TargetsData[i].Weight);
+	for (int32 i = 0; i < TargetsNum; ++i)
+	{
+		const FColor DisplayColor = i == 0 ? FColor::Yellow : FColor::White;
+		const FVector2D ScreenLoc = CanvasContext.ProjectLocation(DetailedResponse.TargetsData[i].Location);
+		const FString ModifierString = FString::Printf(TEXT("%.2f"), DetailedResponse.TargetsData[i].Weight);
 
-			float ModifierXSize, ModifierYSize;
-			CanvasContext.MeasureString(ModifierString, ModifierXSize, ModifierYSize);
-			CanvasContext.PrintAt(ScreenLoc.X - ModifierXSize / 2.f, ScreenLoc.Y - ModifierYSize / 2.f, DisplayColor, ModifierString);
-		}
+		float ModifierXSize, ModifierYSize;
+		CanvasContext.MeasureString(ModifierString, ModifierXSize, ModifierYSize);
+		CanvasContext.PrintAt(ScreenLoc.X - ModifierXSize / 2.f, ScreenLoc.Y - ModifierYSize / 2.f, DisplayColor, ModifierString);
 	}
 }
 
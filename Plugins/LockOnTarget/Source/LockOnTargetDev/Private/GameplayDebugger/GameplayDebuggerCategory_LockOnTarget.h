@@ -7,10 +7,10 @@
 #include "CoreMinimal.h"
 #include "UObject/WeakObjectPtr.h"
 #include "GameplayDebuggerCategory.h"
+#include "TargetHandlers/WeightedTargetHandler.h"
 
 struct FFindTargetContext;
 struct FTargetContext;
-struct FFindTargetRequestResponse;
 
 class APlayerController;
 class ULockOnTargetComponent;
@@ -52,6 +52,9 @@ private:
 	float SimulatedPlayerInput;
 	uint8 bSimulateTargetHandler : 1;
 
+	//Simulated every frame, so the detailed response buffer is reused.
+	FWeightedDetailedResponseData SimulatedResponse;
+
 private:
 
 	//General Info
@@ -65,7 +68,7 @@ private:
 
 	//TargetHandler
 	void SimulateTargetHandler(FGameplayDebuggerCanvasContext& CanvasContext);
-	void DrawWeights(FGameplayDebuggerCanvasContext& CanvasContext, const FFindTargetRequestResponse& Response);
+	void DrawWeights(FGameplayDebuggerCanvasContext& CanvasContext, const FWeightedDetailedResponseData& DetailedResponse);
 	void DrawPlayerInput(UWeightedTargetHandler* TargetHandler, FGameplayDebuggerCanvasContext& CanvasContext);
 
 	//Input